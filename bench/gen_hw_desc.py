@@ -0,0 +1,125 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+#   Licensed under the Apache License, Version 2.0 (the "License"); you may
+#   not use this file except in compliance with the License. You may obtain
+#   a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+#   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+#   License for the specific language governing permissions and limitations
+#   under the License.
+
+"""Generate synthetic hardware description trees for ops-ledd.
+
+Writes one hw_desc_dir per subsystem under OUTDIR, each with a
+manifest.yaml, a devices.yaml with K CPLDs and a led.yaml with M "loc"
+LEDs spread over the devices, two LEDs per 8-bit register. The files
+follow the layout of the ops-hw-config description files.
+
+By default every subsystem gets its own files; with --shared, they all
+point at one directory, as line cards of the same model do.
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+
+LEDS_PER_REG = 2
+FIRST_REG = 0x10
+FIRST_ADDRESS = 0x40
+
+
+def write(path, text):
+    with open(path, 'w') as f:
+        f.write(text)
+
+
+def gen_manifest(dir_):
+    write(os.path.join(dir_, 'manifest.yaml'),
+          '---\n'
+          '# Synthetic hardware description for ops-ledd benchmarks\n'
+          'version: 0.1.0\n'
+          'devices: devices.yaml\n'
+          'led: led.yaml\n')
+
+
+def gen_devices(dir_, n_devices, tag):
+    lines = ['---', '# {}'.format(tag), 'devices:']
+    for dev in range(n_devices):
+        lines += ['  - name: cpld{}'.format(dev),
+                  '    bus: i2c-{}'.format(dev % 4),
+                  '    dev_type: cpld',
+                  '    address: 0x{:02x}'.format(FIRST_ADDRESS + dev)]
+    write(os.path.join(dir_, 'devices.yaml'), '\n'.join(lines) + '\n')
+
+
+def gen_leds(dir_, n_leds, n_devices, tag):
+    lines = ['---', '# {}'.format(tag),
+             'led_info:',
+             '  number_types: 1',
+             '  number_leds: {}'.format(n_leds),
+             'led_types:',
+             '  - type: loc',
+             '    settings:',
+             '      on: 0x1',
+             '      off: 0x0',
+             '      flashing: 0x2',
+             'leds:']
+    for led in range(n_leds):
+        dev = led % n_devices
+        slot = led // n_devices
+        reg = FIRST_REG + slot // LEDS_PER_REG
+        shift = 4 * (slot % LEDS_PER_REG)
+        lines += ['  - name: led{}'.format(led),
+                  '    type: loc',
+                  '    led_access:',
+                  '      device: cpld{}'.format(dev),
+                  '      register_address: 0x{:02x}'.format(reg),
+                  '      register_size: 1',
+                  '      bit_mask: 0x{:02x}'.format(0x3 << shift)]
+    write(os.path.join(dir_, 'led.yaml'), '\n'.join(lines) + '\n')
+
+
+def gen_tree(outdir, n_subsystems, n_leds, n_devices, shared=False):
+    """Generate the tree, and return [(subsystem name, hw_desc_dir)]."""
+    subsystems = []
+    for sub in range(n_subsystems):
+        name = 'bench{}'.format(sub)
+        dir_ = os.path.join(outdir, 'shared' if shared else name)
+        if not shared or sub == 0:
+            if not os.path.isdir(dir_):
+                os.makedirs(dir_)
+            tag = 'shared' if shared else name
+            gen_manifest(dir_)
+            gen_devices(dir_, n_devices, tag)
+            gen_leds(dir_, n_leds, n_devices, tag)
+        subsystems.append((name, os.path.abspath(dir_)))
+    return subsystems
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('outdir')
+    parser.add_argument('-n', '--subsystems', type=int, default=1)
+    parser.add_argument('-m', '--leds', type=int, default=10,
+                        help='LEDs per subsystem')
+    parser.add_argument('-k', '--devices', type=int, default=1,
+                        help='devices per subsystem')
+    parser.add_argument('--shared', action='store_true',
+                        help='one hw_desc_dir for all subsystems')
+    args = parser.parse_args()
+
+    for name, dir_ in gen_tree(args.outdir, args.subsystems, args.leds,
+                               args.devices, args.shared):
+        print(name, dir_)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,266 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+#   Licensed under the Apache License, Version 2.0 (the "License"); you may
+#   not use this file except in compliance with the License. You may obtain
+#   a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+#   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+#   License for the specific language governing permissions and limitations
+#   under the License.
+
+"""Startup and scale benchmark for ops-ledd.
+
+For each scale, generates synthetic hardware descriptions (see
+gen_hw_desc.py), starts a private ovsdb-server with the OpenSwitch schema,
+adds one Subsystem row per subsystem and starts ops-ledd on it with the
+simulated LED I/O backend (--led-io=sim), so that no hardware is touched
+and bus transactions can take a set latency. It then reports:
+
+  - the time to the first LED, from ops-ledd/startup, and the time until
+    every LED row is published
+  - the latency of LED state changes: the time from committing a new
+    state to the LED row until ops-ledd has written the LED register, seen
+    as a change of the bus write counter of ops-ledd/dump (this includes
+    the cost of polling ops-ledd/dump)
+  - the resident set size of ops-ledd once all LEDs are up
+  - the bus transactions ops-ledd did to bring the LEDs up, and per
+    state change
+
+With --max-growth, it fails if the time to bring all LEDs up grows faster
+than linearly with the LED count, by more than the given factor, between
+the smallest scale of at least 1k LEDs and the largest one.
+"""
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import random
+import shutil
+import subprocess
+import sys
+import time
+
+from gen_hw_desc import gen_tree
+
+# (subsystems, LEDs per subsystem, devices per subsystem)
+SCALES = {
+    '10': (1, 10, 1),
+    '1k': (10, 100, 4),
+    '10k': (100, 100, 4),
+}
+
+
+class Bench(object):
+    def __init__(self, args, workdir):
+        self.args = args
+        self.workdir = workdir
+        self.db_sock = 'unix:' + os.path.join(workdir, 'db.sock')
+        self.ledd_ctl = os.path.join(workdir, 'ops-ledd.ctl')
+        self.procs = []
+
+    def run(self, *cmd):
+        return subprocess.check_output(cmd).decode()
+
+    def start(self, cmd):
+        log = open(os.path.join(self.workdir,
+                                os.path.basename(cmd[0]) + '.log'), 'w')
+        proc = subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT)
+        self.procs.append(proc)
+        return proc
+
+    def stop(self):
+        for proc in reversed(self.procs):
+            proc.terminate()
+            proc.wait()
+        self.procs = []
+
+    def wait_for(self, what, check, timeout):
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            result = check()
+            if result:
+                return result
+            time.sleep(0.01)
+        raise RuntimeError('timed out waiting for ' + what)
+
+    def start_ovsdb(self):
+        db = os.path.join(self.workdir, 'ledd.db')
+        self.run('ovsdb-tool', 'create', db, self.args.schema)
+        self.start(['ovsdb-server', db,
+                    '--remote=p' + self.db_sock,
+                    '--unixctl=' + os.path.join(self.workdir, 'ovsdb.ctl')])
+        self.wait_for('ovsdb-server',
+                      lambda: os.path.exists(self.db_sock[5:]), 10)
+        self.db_name = self.run('ovsdb-client', 'list-dbs',
+                                self.db_sock).split()[0]
+
+    def transact(self, ops):
+        return json.loads(self.run('ovsdb-client', 'transact', self.db_sock,
+                                   json.dumps([self.db_name] + ops)))
+
+    def add_subsystems(self, subsystems):
+        ops = [{'op': 'insert', 'table': 'Subsystem',
+                'row': {'name': name, 'hw_desc_dir': dir_}}
+               for name, dir_ in subsystems]
+        for result in self.transact(ops):
+            if 'error' in result:
+                raise RuntimeError('unable to add subsystems: {}'
+                                   .format(result))
+
+    def appctl(self, command):
+        return self.run('ovs-appctl', '-t', self.ledd_ctl, command)
+
+    def led_ids(self):
+        rows = self.transact([{'op': 'select', 'table': 'LED', 'where': [],
+                               'columns': ['id']}])[0]['rows']
+        return [row['id'] for row in rows]
+
+    def bus_writes(self):
+        for line in self.appctl('ops-ledd/dump').split('\n'):
+            if line.startswith('Bus register writes:'):
+                return int(line.split(':')[1].split()[0])
+        return 0
+
+    def bus_transactions(self):
+        for line in self.appctl('ops-ledd/io-backend').split('\n'):
+            if line.startswith('Sim transactions:'):
+                return int(line.split(':')[1].split(',')[0])
+        return 0
+
+    def rss_kb(self, pid):
+        with open('/proc/{}/status'.format(pid)) as f:
+            for line in f:
+                if line.startswith('VmRSS:'):
+                    return int(line.split()[1])
+        return 0
+
+    def measure(self, scale):
+        n_subsystems, n_leds, n_devices = SCALES[scale]
+        total = n_subsystems * n_leds
+
+        subsystems = gen_tree(os.path.join(self.workdir, 'hw'), n_subsystems,
+                              n_leds, n_devices, self.args.shared)
+        self.start_ovsdb()
+        self.add_subsystems(subsystems)
+
+        started = time.time()
+        ledd = self.start([self.args.ledd, self.db_sock,
+                           '--unixctl=' + self.ledd_ctl,
+                           '--led-io=sim:latency={},jitter={}'
+                           .format(self.args.latency, self.args.jitter),
+                           '--led-image-dir=',
+                           '-vconsole:emer'])
+        self.wait_for('ops-ledd', lambda: os.path.exists(self.ledd_ctl), 10)
+        self.wait_for('LED rows', lambda: len(self.led_ids()) >= total,
+                      self.args.timeout)
+        all_up = (time.time() - started) * 1000
+
+        first = '-'
+        for line in self.appctl('ops-ledd/startup').split('\n'):
+            if line.startswith('Time to first LED:'):
+                first = line.split(':')[1].strip()
+        rss = self.rss_kb(ledd.pid)
+        startup_ops = self.bus_transactions()
+
+        # LEDs start off; each sample flips one, so that it is a change
+        states = dict((led, 'off') for led in self.led_ids())
+        latencies = []
+        for _ in range(self.args.samples):
+            led = random.choice(list(states))
+            states[led] = 'on' if states[led] == 'off' else 'off'
+            writes = self.bus_writes()
+            t0 = time.time()
+            self.transact([{'op': 'update', 'table': 'LED',
+                            'where': [['id', '==', led]],
+                            'row': {'state': states[led]}}])
+            self.wait_for('LED write',
+                          lambda: self.bus_writes() > writes, 10)
+            latencies.append((time.time() - t0) * 1000)
+        change_ops = self.bus_transactions() - startup_ops
+        latencies.sort()
+
+        def pct(p):
+            return latencies[min(len(latencies) - 1,
+                                 int(len(latencies) * p / 100))]
+
+        print('{:>5} LEDs ({} x {}, {} devices): first LED {}, all LEDs '
+              '{:.1f} ms, RSS {} kB'.format(total, n_subsystems, n_leds,
+                                            n_devices, first, all_up, rss))
+        print('       state change latency (ms): p50 {:.2f}, p90 {:.2f}, '
+              'p99 {:.2f}, max {:.2f}'.format(pct(50), pct(90), pct(99),
+                                              latencies[-1]))
+        print('       bus transactions: {} to bring LEDs up, {:.2f} per '
+              'state change'.format(startup_ops,
+                                    float(change_ops) / len(latencies)))
+        sys.stdout.flush()
+        return total, all_up
+
+
+def check_growth(results, max_growth):
+    """Check that the bring-up time grows at most max_growth times faster
+    than the LED count. Scales below 1k LEDs are left out, as their
+    bring-up time is mostly fixed costs."""
+    results = sorted(r for r in results if r[0] >= 1000)
+    if len(results) < 2:
+        print('not enough scales of 1k LEDs or more to check growth')
+        return True
+
+    (n0, t0), (n1, t1) = results[0], results[-1]
+    growth = (t1 / t0) / (float(n1) / n0)
+    print('bring-up time grows {:.2f}x the LED count from {} to {} LEDs '
+          '(limit {:.2f}x)'.format(growth, n0, n1, max_growth))
+    return growth <= max_growth
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--ledd', default='ops-ledd',
+                        help='ops-ledd binary')
+    parser.add_argument('--schema', required=True,
+                        help='OpenSwitch OVSDB schema')
+    parser.add_argument('--workdir', default='ledd-bench')
+    parser.add_argument('--scales', default='10,1k,10k',
+                        help='comma separated, from: ' + ', '.join(SCALES))
+    parser.add_argument('--samples', type=int, default=200,
+                        help='state changes to time at each scale')
+    parser.add_argument('--shared', action='store_true',
+                        help='one hw_desc_dir for all subsystems')
+    parser.add_argument('--latency', type=int, default=0,
+                        help='simulated bus transaction latency, in us')
+    parser.add_argument('--jitter', type=int, default=0,
+                        help='simulated random extra latency, in us')
+    parser.add_argument('--timeout', type=float, default=300,
+                        help='seconds to wait for all LEDs to come up')
+    parser.add_argument('--max-growth', type=float, default=0,
+                        help='fail if bring-up time grows this many times '
+                             'faster than the LED count (0 to not check)')
+    args = parser.parse_args()
+
+    results = []
+
+    for scale in args.scales.split(','):
+        workdir = os.path.abspath(os.path.join(args.workdir, scale))
+        shutil.rmtree(workdir, ignore_errors=True)
+        os.makedirs(workdir)
+
+        bench = Bench(args, workdir)
+        try:
+            results.append(bench.measure(scale))
+        finally:
+            bench.stop()
+
+    if args.max_growth and not check_growth(results, args.max_growth):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,229 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Microbenchmark of a model of the CPU cost of an LED write
+ *
+ * This is a model, not a measurement of ops-ledd: it times private copies
+ * of the two ways of working out the value to write for an LED state
+ * change, before and after LEDs were compiled into write plans, and does
+ * not run ledd_compile_led_plan(), ledd_write_led() or struct
+ * ledd_led_plan, which may change without it following:
+ *
+ *     lookup   the type of the LED found by a walk of the subsystem types
+ *              with strcmp(), the type name converted to an enum with
+ *              strcmp(), and a switch on the type and the state
+ *     plan     an index into the flat write plan of the subsystem, then
+ *              into its value per state
+ *
+ * The bus operation that follows is the same in both cases, and is left
+ * out. Its results compare the two approaches, and do not stand for the
+ * speedup of ops-ledd itself; the scale benchmark (bench/ledd_bench.py)
+ * measures the daemon. Usage: ledd_write_bench [TYPES [LEDS [WRITES]]]
+ ***************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_TYPES     8               /*!< Default LED types */
+#define BENCH_LEDS      1024            /*!< Default LEDs */
+#define BENCH_WRITES    10000000        /*!< Default writes timed */
+
+enum bench_state { STATE_OFF, STATE_ON, STATE_FLASHING, NUM_STATES };
+enum bench_type { TYPE_LOC, TYPE_UNKNOWN };
+
+/* LED type, as parsed from led.yaml */
+struct bench_led_type {
+    char *type;
+    uint32_t on, off, flashing;
+};
+
+/* LED, as described in led.yaml, with its register access */
+struct bench_led {
+    const char *type;
+    uint32_t reg;
+    uint32_t mask;
+    enum bench_state state;
+};
+
+/* compiled write plan of an LED */
+struct bench_plan {
+    uint32_t reg;
+    uint32_t mask;
+    uint32_t value[NUM_STATES];
+};
+
+static volatile uint32_t sink;          /*!< Keeps the values computed */
+
+static long long int
+bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((long long int)ts.tv_sec * 1000000000LL + ts.tv_nsec);
+} /* bench_now_ns() */
+
+static enum bench_type
+bench_type_to_enum(const char *type)
+{
+    if (strcmp(type, "loc") == 0) {
+        return(TYPE_LOC);
+    }
+    return(TYPE_UNKNOWN);
+} /* bench_type_to_enum() */
+
+/* the value of an LED, the way ledd_write_led() used to find it */
+static int
+bench_lookup_value(const struct bench_led_type *types, int n_types,
+                   const struct bench_led *led, uint32_t *value)
+{
+    const struct bench_led_type *type = NULL;
+    int idx;
+
+    for (idx = 0; idx < n_types; idx++) {
+        if (strcmp(types[idx].type, led->type) == 0) {
+            type = &types[idx];
+            break;
+        }
+    }
+    if (type == NULL) {
+        return(-1);
+    }
+
+    switch (bench_type_to_enum(type->type)) {
+    case TYPE_LOC:
+        switch (led->state) {
+        case STATE_FLASHING:
+            *value = type->flashing;
+            break;
+        case STATE_OFF:
+            *value = type->off;
+            break;
+        case STATE_ON:
+            *value = type->on;
+            break;
+        default:
+            return(-1);
+        }
+        break;
+    default:
+        return(-1);
+    }
+
+    return(0);
+} /* bench_lookup_value() */
+
+/* ns per write of n_writes writes spread over the LEDs, by either path */
+static double
+bench_run(const struct bench_led_type *types, int n_types,
+          struct bench_led *leds, const struct bench_plan *plans,
+          int n_leds, long n_writes, int use_plan)
+{
+    long long int start;
+    uint32_t value = 0;
+    long i;
+
+    start = bench_now_ns();
+    for (i = 0; i < n_writes; i++) {
+        struct bench_led *led = &leds[i % n_leds];
+
+        led->state = (led->state + 1) % NUM_STATES;
+        if (use_plan) {
+            const struct bench_plan *plan = &plans[i % n_leds];
+
+            value = (value & ~plan->mask) | plan->value[led->state];
+        } else if (bench_lookup_value(types, n_types, led, &value) != 0) {
+            abort();
+        }
+    }
+    sink = value;
+
+    return((double)(bench_now_ns() - start) / n_writes);
+} /* bench_run() */
+
+int
+main(int argc, char *argv[])
+{
+    int n_types = argc > 1 ? atoi(argv[1]) : BENCH_TYPES;
+    int n_leds = argc > 2 ? atoi(argv[2]) : BENCH_LEDS;
+    long n_writes = argc > 3 ? atol(argv[3]) : BENCH_WRITES;
+    struct bench_led_type *types;
+    struct bench_led *leds;
+    struct bench_plan *plans;
+    double lookup_ns, plan_ns;
+    int idx;
+
+    if (n_types < 1 || n_leds < 1 || n_writes < 1) {
+        fprintf(stderr, "usage: %s [TYPES [LEDS [WRITES]]]\n", argv[0]);
+        return(EXIT_FAILURE);
+    }
+
+    /* "loc" is the last type, the worst case of the walk, as every LED of
+       a subsystem with many types may be */
+    types = calloc(n_types, sizeof *types);
+    for (idx = 0; idx < n_types; idx++) {
+        types[idx].type = malloc(32);
+        if (idx == n_types - 1) {
+            strcpy(types[idx].type, "loc");
+        } else {
+            snprintf(types[idx].type, 32, "type_%d", idx);
+        }
+        types[idx].on = 1;
+        types[idx].off = 0;
+        types[idx].flashing = 2;
+    }
+
+    leds = calloc(n_leds, sizeof *leds);
+    plans = calloc(n_leds, sizeof *plans);
+    for (idx = 0; idx < n_leds; idx++) {
+        const struct bench_led_type *type = &types[n_types - 1];
+
+        leds[idx].type = type->type;
+        leds[idx].reg = idx / 4;
+        leds[idx].mask = 0x3 << (2 * (idx % 4));
+        plans[idx].reg = leds[idx].reg;
+        plans[idx].mask = leds[idx].mask;
+        plans[idx].value[STATE_OFF] = type->off << (2 * (idx % 4));
+        plans[idx].value[STATE_ON] = type->on << (2 * (idx % 4));
+        plans[idx].value[STATE_FLASHING] = type->flashing << (2 * (idx % 4));
+    }
+
+    lookup_ns = bench_run(types, n_types, leds, plans, n_leds, n_writes, 0);
+    plan_ns = bench_run(types, n_types, leds, plans, n_leds, n_writes, 1);
+
+    printf("model of an LED write: %d LED types, %d LEDs, %ld writes\n",
+           n_types, n_leds, n_writes);
+    printf("lookup model: %8.2f ns per write\n", lookup_ns);
+    printf("plan model:   %8.2f ns per write (%.1fx)\n", plan_ns,
+           plan_ns > 0 ? lookup_ns / plan_ns : 0.0);
+
+    for (idx = 0; idx < n_types; idx++) {
+        free(types[idx].type);
+    }
+    free(types);
+    free(leds);
+    free(plans);
+
+    return(EXIT_SUCCESS);
+} /* main() */
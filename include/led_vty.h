@@ -30,13 +30,24 @@
 
 #define LED_STR 	"LED information\n"
 #define LED_SET_STR 	"Set LED state\n"
+#define LED_PAGE_LINES	100	/* LEDs per page of show system led */
+#define LED_PAGE_MAX	100000	/* Most LEDs per page, or pages */
+
+#define LED_NAME_STR	"Name of LED e.g. <base-loc> for locator LED, a range "\
+			"e.g. <base-port-1-48>, or a pattern e.g. <base-port-*>\n"
 
 int cli_system_no_set_led(char* sLedName);
 
-int cli_system_get_led();
+int cli_system_get_led(const char *sSubsysName, const char *sState,
+                       const char *sStatus, unsigned int page,
+                       unsigned int lines);
+
+int cli_system_get_led_summary(void);
 
 int cli_system_set_led(char* sLedName,char* sLedState);
 
+int cli_system_set_subsystem_leds(char* sSubsysName,char* sLedState);
+
 void cli_pri_init(void);
 void cli_post_init(void);
 #endif //_LED_VTY_H
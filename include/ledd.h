@@ -62,6 +62,35 @@
  *                                  (default: /var/log/openvswitch/ops-ledd.log)
  *          --syslog-target=HOST:PORT  also send syslog msgs to HOST:PORT via UDP
  *
+ *     LED options:
+ *          --disable-block-writes  write each LED register on its own
+ *          --load-threads=N        load hw description files with N threads
+ *                                  (default: one per CPU core, up to 8)
+ *          --led-image-dir=DIR     save compiled LED descriptions in DIR,
+ *                                  "" not to (default: /var/run/ops-ledd)
+ *          --led-io=BACKEND[:OPTS] LED I/O backend: i2c (default), or sim
+ *                                  to emulate the LED devices in memory
+ *          --disable-led-io        same as --led-io=sim
+ *          --sysfs-leds-dir=DIR    LED class directory for "sysfs:" LEDs
+ *                                  (default: /sys/class/leds)
+ *          --coalesce-window=MS    apply a burst of db changes, made less
+ *                                  than MS apart, in one pass (default: 10,
+ *                                  0 to apply each change on its own)
+ *          --coalesce-max=MS       but never hold a change for more than MS
+ *                                  (default: 100)
+ *          --bringup-chunk=N       write and publish at most N LEDs of new
+ *                                  subsystems per pass and per transaction
+ *                                  (default: 256, 0 for no limit)
+ *          --hot-standby           without the lock, keep the LED state
+ *                                  current, to take over at once
+ *          --shard=SHARD           handle only the subsystems of SHARD: a
+ *                                  name pattern, or hash:A-B/N for the
+ *                                  names hashing into slots A to B of N
+ *          --shards=SHARD,...      set cur_hw once all these shards are
+ *                                  ready (default: the --shard alone)
+ *          --lock-name=NAME        OVSDB lock to take (default: ops_ledd,
+ *                                  or ops_ledd_shard_HASH with --shard)
+ *
  *     Other options:
  *          --unixctl=SOCKET        override default control socket name
  *          -h, --help              display this help message
@@ -71,6 +100,10 @@
  * ovs-apptcl options:
  *
  *      Support dump: ovs-appctl -t ops-ledd ops-ledd/dump
+ *      Startup timing: ovs-appctl -t ops-ledd ops-ledd/startup
+ *      LED I/O backend: ovs-appctl -t ops-ledd ops-ledd/io-backend [OPTS]
+ *      Latency stats: ovs-appctl -t ops-ledd ops-ledd/stats [reset]
+ *      Main loop profile: ovs-appctl -t ops-ledd ops-ledd/profile [reset]
  *
  *
  * OVSDB elements usage
@@ -90,6 +123,10 @@
  *           led:state
  *           subsystem:name
  *           subsystem:hw_desc_dir
+ *           subsystem:other_config:led_pattern:<name> (LED pattern definition)
+ *           subsystem:other_config:led:<led> (pattern of a flashing LED)
+ *           subsystem:other_config:led_coalesce_window (ms, see --coalesce-window)
+ *           subsystem:other_config:led_coalesce_max (ms, see --coalesce-max)
  *
  * Linux Files:
  *
@@ -105,17 +142,65 @@
 #define _LEDD_H_
 
 #include <stdbool.h>
+#include "hmap.h"
+#include "list.h"
 #include "shash.h"
+#include "uuid.h"
+#include "smap.h"
 #include "config-yaml.h"
+#include "ledd_hist.h"
+#include "ledd_load.h"
+#include "ledd_pattern.h"
+#include "ledd_sysfs.h"
+#include "ledd_wheel.h"
 
 /* **************** DEFINES ************* */
 
 #define NAME_IN_DAEMON_TABLE "ops-ledd" /*!< Name identifier for this daemon in the OVSDB daemon table */
 
+#define LEDD_LOCK_NAME          "ops_ledd" /*!< Default OVSDB lock name */
+
+#define LEDD_SHARD_DAEMON_SEP   ':'   /*!< Separates the shard from
+                                           NAME_IN_DAEMON_TABLE in its
+                                           daemon row */
+
 #define LEDD_LED_TYPE_LOC       "loc" /*!< Name identifier for LED type loc */
 
+#define LEDD_BLINK_TICK_MS      10    /*!< Blink timer wheel tick, in ms */
+
+#define LEDD_PATTERN_KEY_PREFIX "led_pattern:" /*!< other_config key prefix
+                                                    defining a pattern */
+#define LEDD_LED_KEY_PREFIX     "led:"  /*!< other_config key prefix
+                                             selecting an LED pattern */
+#define LEDD_COALESCE_WINDOW_KEY "led_coalesce_window" /*!< other_config key
+                                             of the coalescing window, ms */
+#define LEDD_COALESCE_MAX_KEY   "led_coalesce_max" /*!< other_config key of
+                                             the coalescing latency cap, ms */
+
+#define LEDD_COALESCE_WINDOW_MS 10    /*!< Default coalescing window */
+#define LEDD_COALESCE_MAX_MS    100   /*!< Default coalescing latency cap */
+
+#define LEDD_TXN_BACKOFF_MIN_MS 100   /*!< First wait after a failed txn */
+#define LEDD_TXN_BACKOFF_MAX_MS 10000 /*!< Longest wait after failed txns */
+
+#define LEDD_BRINGUP_CHUNK      256   /*!< Default LEDs of new subsystems
+                                           written per pass and published
+                                           per transaction */
+
 VLOG_DEFINE_THIS_MODULE(ops_ledd);
 COVERAGE_DEFINE(ledd_reconfigure);
+COVERAGE_DEFINE(ledd_led_row_change);
+COVERAGE_DEFINE(ledd_txn_commit);
+COVERAGE_DEFINE(ledd_txn_try_again);
+COVERAGE_DEFINE(ledd_txn_failed);
+COVERAGE_DEFINE(ledd_blink_tick);
+COVERAGE_DEFINE(ledd_coalesced);
+COVERAGE_DEFINE(ledd_write_skipped);
+COVERAGE_DEFINE(ledd_wakeup_idl);
+COVERAGE_DEFINE(ledd_wakeup_timer);
+COVERAGE_DEFINE(ledd_wakeup_unixctl);
+COVERAGE_DEFINE(ledd_wakeup_worker);
+COVERAGE_DEFINE(ledd_wakeup_other);
 
 /* **************** TYPEDEFS  ************* */
 
@@ -137,6 +222,9 @@ const char *led_state_strings[] = {
     OVSREC_LED_STATE_ON                 /*!< LED state "on" */
 };
 
+#define LEDD_NUM_STATES (sizeof(led_state_strings)/sizeof(const char *))
+                                /*!< Number of supported led states */
+
 /************************************************************************//**
  * char array containing the string name for supported led statuses. These
  * are defined in the OVS schema for the LED table.
@@ -148,11 +236,96 @@ const char *led_status_strings[] = {
 };
 
 /************************************************************************//**
- * ENUM to indicate if the subsystem is valid (OK), or not (IGNORE).
+ * ENUM to indicate if the subsystem is valid (OK), or not (IGNORE), or
+ * still having its hardware description files loaded (LOADING).
  ***************************************************************************/
 enum subsysstatus {
     LEDD_SUBSYS_STATUS_OK,              /*!< Subsystem is ok, process */
-    LEDD_SUBSYS_STATUS_IGNORE           /*!< Subsystem not ok, don't process */
+    LEDD_SUBSYS_STATUS_IGNORE,          /*!< Subsystem not ok, don't process */
+    LEDD_SUBSYS_STATUS_LOADING          /*!< Subsystem files being loaded */
+};
+
+/************************************************************************//**
+ * ENUM of the stages of an LED state change, from OVSDB to the hardware
+ * and back, whose latency is kept per subsystem.
+ ***************************************************************************/
+enum ledd_stage {
+    LEDD_STAGE_DISPATCH,                /*!< IDL delivery to ledd_write_led */
+    LEDD_STAGE_WRITE,                   /*!< ledd_write_led to LED written */
+    LEDD_STAGE_COMMIT,                  /*!< LED written to status in db */
+    LEDD_STAGE_TOTAL,                   /*!< IDL delivery to status in db */
+    LEDD_NUM_STAGES
+};
+
+/************************************************************************//**
+ * ENUM of the times recorded for an LED state change in flight.
+ ***************************************************************************/
+enum ledd_stamp {
+    LEDD_STAMP_CHANGED,                 /*!< Delivered by ovsdb_idl_run() */
+    LEDD_STAMP_WRITE,                   /*!< ledd_write_led() started */
+    LEDD_STAMP_WRITTEN,                 /*!< Write to the LED done */
+    LEDD_NUM_STAMPS
+};
+
+/************************************************************************//**
+ * STRUCT holding the shadow copy of an LED control register. ledd assumes
+ * it owns the registers its LEDs live in, so the shadow is read from the
+ * hardware once and then kept up to date by every write.
+ *
+ * Register I/O is done by the bus workers, so the shadow tracks both the
+ * value known to be in the register and the value it will have once the
+ * jobs in flight are done. LED changes are batched as bits to change,
+ * which can be merged even before the register has been read.
+ ***************************************************************************/
+struct ledd_reg {
+    struct hmap_node node;              /*!< In locl_subsystem led_regs */
+    struct locl_subsystem *subsystem;   /*!< Subsystem, NULL once removed */
+    const char *device;                 /*!< Device holding the register */
+    const YamlDevice *yaml_device;      /*!< Device access information */
+    uint32_t reg;                       /*!< Register address */
+    uint32_t size;                      /*!< Register size, in bytes */
+    uint32_t value;                     /*!< Last value read or written */
+    bool valid;                         /*!< True if value is known */
+    uint32_t queued;                    /*!< Value once jobs are done */
+    uint32_t pend_mask;                 /*!< Bits to change, if dirty */
+    uint32_t pend_bits;                 /*!< New value of those bits */
+    bool dirty;                         /*!< True if in the write batch */
+    bool reading;                       /*!< True if a read is in flight */
+    bool read_failed;                   /*!< True if the last read failed */
+    unsigned int n_inflight;            /*!< Bus jobs in flight */
+    struct ledd_reg_job *last_job;      /*!< Last write in flight, or NULL */
+    struct ovs_list batch_node;         /*!< In the write batch */
+};
+
+/************************************************************************//**
+ * STRUCT holding the compiled write plan of an LED: the control register
+ * access and the value to write for each led state. It is built once when
+ * the subsystem is added, so writing an LED needs no lookups.
+ ***************************************************************************/
+struct ledd_led_plan {
+    const char *device;                 /*!< Device holding the register */
+    uint32_t reg;                       /*!< Register address */
+    uint32_t size;                      /*!< Register size, in bytes */
+    uint32_t mask;                      /*!< LED bits in the register */
+    uint32_t value[LEDD_NUM_STATES];    /*!< Value to write, by led state */
+    uint32_t bits[LEDD_NUM_STATES];     /*!< Value shifted into the mask */
+    struct ledd_reg *shadow;            /*!< Shadow of the register */
+    struct ledd_sysfs_led *sysfs;       /*!< LED class device, or NULL */
+    bool soft_blink;                    /*!< Flashing is done by ledd */
+    bool valid;                         /*!< False if LED type is unknown */
+};
+
+/************************************************************************//**
+ * STRUCT holding the LEDs that ledd blinks in software with the same
+ * pattern. All of them are stepped by a single timer, at step boundaries
+ * counted from a common origin, so they blink in sync.
+ ***************************************************************************/
+struct ledd_blink_group {
+    struct hmap_node node;              /*!< In blink_groups */
+    struct ledd_wheel_timer timer;      /*!< Next step, if any */
+    const struct ledd_pattern *pattern; /*!< Pattern run by the LEDs */
+    long long int origin;               /*!< Pattern start, in ms */
+    struct ovs_list leds;               /*!< locl_led structs blinking */
 };
 
 /************************************************************************//**
@@ -161,13 +334,30 @@ enum subsysstatus {
  ***************************************************************************/
 struct locl_subsystem {
     char *name;                         /*!< Name of the subsystem */
+    struct uuid ovs_uuid;               /*!< OVSDB subsystem row */
     bool marked;                        /*!< True if subsystem exists*/
+    bool publish_pending;               /*!< LED rows need to be published */
+    bool publish_inflight;              /*!< LED rows are in commit_txn */
+    struct locl_led **bringup;          /*!< LEDs in bring-up order, loc
+                                             LEDs first */
+    size_t n_bringup;                   /*!< LEDs in bringup */
+    size_t n_loc;                       /*!< loc LEDs, first in bringup */
+    size_t n_written;                   /*!< bringup LEDs written so far */
+    size_t n_published;                 /*!< bringup LEDs with committed rows */
+    size_t n_publishing;                /*!< bringup LEDs published once
+                                             commit_txn succeeds */
     struct locl_subsystem *parent_subsystem; /*!< parent subsystem */
     int num_leds;                       /*!< Number of LEDs in subsystem */
     int num_types;                      /*!< Number of LED types in subsystem */
     struct shash subsystem_leds;        /*!< shash of locl_led structs*/
-    struct shash subsystem_types;       /*!< shash of YamlLedType structs */
-    enum subsysstatus subsys_status;    /*!< status {OK, IGNORE} */
+    struct ledd_led_plan *led_plans;    /*!< Write plans, one per LED */
+    struct hmap led_regs;               /*!< hmap of ledd_reg structs */
+    struct shash patterns;              /*!< shash of ledd_pattern structs */
+    struct smap pattern_config;         /*!< Pattern keys of other_config */
+    enum subsysstatus subsys_status;    /*!< status {OK, IGNORE, LOADING} */
+    struct ledd_desc *desc;             /*!< Hardware description data */
+    struct ledd_load_times load_times;  /*!< Startup timing */
+    struct ledd_hist latency[LEDD_NUM_STAGES]; /*!< State change latency */
 };
 
 /************************************************************************//**
@@ -176,10 +366,18 @@ struct locl_subsystem {
 struct locl_led {
     char *name;                         /*!< LED name */
     struct locl_subsystem *subsystem;   /*!< Subsystem this LED is in */
-    const YamlLed *yaml_led;            /*!< YamlLed struct for this LED */
-    YamlLedTypeSettings *settings;      /*!< Settings for this LED */
+    const char *type;                   /*!< LED type name, in the image */
+    const struct ledd_led_plan *plan;   /*!< Write plan for this LED */
     enum ovsrec_led_state_e state;      /*!< Last state in OVSDB */
-    enum ovsrec_led_status_e status;    /*!< Last status in OVSDB */
+    enum ovsrec_led_status_e status;    /*!< Last status written */
+    struct uuid row_uuid;               /*!< OVSDB row, zero if not known */
+    struct ovs_list status_node;        /*!< In dirty or in-flight list */
+    struct ovs_list write_node;         /*!< In write batch or job */
+    const struct ledd_pattern *pattern; /*!< Pattern when flashing, or NULL */
+    struct ledd_blink_group *blink;     /*!< Blink group, or NULL */
+    struct ovs_list blink_node;         /*!< In the blink group */
+    long long int stamps[LEDD_NUM_STAMPS]; /*!< State change times, in us,
+                                                0 if not timed */
 };
 
 #endif /* _LEDD_H_ */
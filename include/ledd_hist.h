@@ -0,0 +1,61 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd latency histograms
+ *
+ * A log-linear histogram, as HdrHistogram keeps: values below
+ * LEDD_HIST_SUB_BUCKETS have a bucket each, and every power of two above
+ * that is split into LEDD_HIST_SUB_BUCKETS buckets, so any value is
+ * recorded within 1/LEDD_HIST_SUB_BUCKETS of its size, from 1us to hours,
+ * in a fixed number of counters. Recording a value is a few shifts and an
+ * increment. The counters are only allocated once a value is recorded.
+ ***************************************************************************/
+
+#ifndef _LEDD_HIST_H_
+#define _LEDD_HIST_H_
+
+#include <stdint.h>
+
+#define LEDD_HIST_SUB_BITS      4       /*!< log2 of sub-buckets per power */
+#define LEDD_HIST_SUB_BUCKETS   (1 << LEDD_HIST_SUB_BITS)
+#define LEDD_HIST_MAX_BITS      36      /*!< Values up to 2^36 (19 hours) */
+#define LEDD_HIST_BUCKETS       \
+    (LEDD_HIST_SUB_BUCKETS * (LEDD_HIST_MAX_BITS - LEDD_HIST_SUB_BITS + 1))
+
+/************************************************************************//**
+ * STRUCT of a histogram.
+ ***************************************************************************/
+struct ledd_hist {
+    uint32_t *counts;                   /*!< LEDD_HIST_BUCKETS, or NULL */
+    uint64_t count;                     /*!< Values recorded */
+    uint64_t sum;                       /*!< Sum of the values */
+    uint64_t min;                       /*!< Smallest value */
+    uint64_t max;                       /*!< Largest value */
+};
+
+struct ds;
+
+void ledd_hist_record(struct ledd_hist *hist, uint64_t value);
+uint64_t ledd_hist_percentile(const struct ledd_hist *hist, double pct);
+void ledd_hist_merge(struct ledd_hist *dst, const struct ledd_hist *src);
+void ledd_hist_reset(struct ledd_hist *hist);
+void ledd_hist_format(struct ds *ds, const struct ledd_hist *hist);
+
+#endif /* _LEDD_HIST_H_ */
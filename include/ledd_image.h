@@ -0,0 +1,117 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd compiled LED description images
+ *
+ * The LEDs of a subsystem, as described by its led.yaml, are compiled into
+ * a flat image: a header, a table of fixed size LED records and a table of
+ * NUL terminated strings that the records point into by offset. Images are
+ * saved under LEDD_IMAGE_DIR, named by the digest of the hardware
+ * description files they were compiled from, so that the next start of
+ * ops-ledd can mmap the image instead of parsing led.yaml again. An image
+ * is only used if its magic, version, size, checksum and digest match,
+ * and if every offset in it is in range.
+ *
+ * At most LEDD_IMAGE_MAX_FILES images are kept in the directory; the
+ * least recently used ones go first, an image being touched each time it
+ * is mapped. An image is not deleted when this process stops using it:
+ * shards and a hot standby share the directory.
+ ***************************************************************************/
+
+#ifndef _LEDD_IMAGE_H_
+#define _LEDD_IMAGE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config-yaml.h"
+#include "sha1.h"
+
+#define LEDD_IMAGE_DIR      "/var/run/ops-ledd" /*!< Default image directory */
+#define LEDD_IMAGE_MAGIC    0x4c454449  /*!< "LEDI", also tells byte order */
+#define LEDD_IMAGE_VERSION  1           /*!< Bump on any layout change */
+#define LEDD_IMAGE_MAX_FILES 64         /*!< Most images kept in the dir */
+#define LEDD_IMAGE_SUFFIX   ".img"      /*!< Suffix of image file names */
+
+#define LEDD_IMAGE_LED_NO_TYPE   0x1    /*!< LED type not in led.yaml */
+#define LEDD_IMAGE_LED_NO_ACCESS 0x2    /*!< No register access information */
+
+/************************************************************************//**
+ * STRUCT of the header of an image. The checksum covers everything after
+ * the header.
+ ***************************************************************************/
+struct ledd_image_header {
+    uint32_t magic;                     /*!< LEDD_IMAGE_MAGIC */
+    uint32_t version;                   /*!< LEDD_IMAGE_VERSION */
+    uint32_t size;                      /*!< Size of the image, in bytes */
+    uint32_t crc;                       /*!< crc32c of the rest of the image */
+    uint8_t digest[SHA1_DIGEST_SIZE];   /*!< Digest of the source files */
+    uint32_t n_types;                   /*!< LED types in led.yaml */
+    uint32_t n_leds;                    /*!< LED records */
+    uint32_t strings;                   /*!< Offset of the string table */
+    uint32_t strings_size;              /*!< Size of the string table */
+};
+
+/************************************************************************//**
+ * STRUCT of the compiled description of one LED. Names are offsets into
+ * the string table.
+ ***************************************************************************/
+struct ledd_image_led {
+    uint32_t name;                      /*!< LED name */
+    uint32_t type;                      /*!< LED type name */
+    uint32_t device;                    /*!< Device of the control register */
+    uint32_t reg;                       /*!< Control register address */
+    uint32_t size;                      /*!< Control register size, in bytes */
+    uint32_t mask;                      /*!< LED bits in the register */
+    uint32_t on;                        /*!< Type setting for on */
+    uint32_t off;                       /*!< Type setting for off */
+    uint32_t flashing;                  /*!< Type setting for flashing */
+    uint32_t flags;                     /*!< LEDD_IMAGE_LED_* */
+};
+
+/************************************************************************//**
+ * STRUCT of an image in memory, either mapped from its file or compiled.
+ ***************************************************************************/
+struct ledd_image {
+    const struct ledd_image_header *header; /*!< Start of the image */
+    const struct ledd_image_led *leds;  /*!< LED records */
+    const char *strings;                /*!< String table */
+    bool mapped;                        /*!< mmapped, else malloced */
+};
+
+struct ledd_image *ledd_image_compile(YamlConfigHandle handle,
+                                      const char *subsystem,
+                                      const uint8_t digest[SHA1_DIGEST_SIZE]);
+struct ledd_image *ledd_image_open(const char *path,
+                                   const uint8_t digest[SHA1_DIGEST_SIZE]);
+int ledd_image_save(const struct ledd_image *image, const char *path);
+void ledd_image_close(struct ledd_image *image);
+void ledd_image_prune(const char *dir, size_t max);
+char *ledd_image_path(const char *dir,
+                      const uint8_t digest[SHA1_DIGEST_SIZE]);
+
+/* string at an offset of the string table of an image */
+static inline const char *
+ledd_image_string(const struct ledd_image *image, uint32_t offset)
+{
+    return(image->strings + offset);
+} /* ledd_image_string() */
+
+#endif /* _LEDD_IMAGE_H_ */
@@ -0,0 +1,106 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd bus I/O workers
+ *
+ * LED register reads and writes are not done on the main thread. They are
+ * submitted as jobs to a worker thread, one per i2c bus, through a
+ * single-producer single-consumer ring, so that a slow or hung device only
+ * stalls the LEDs on its own bus. Completed jobs are handed back through a
+ * second ring and the main loop is woken up through a latch.
+ *
+ * Jobs are owned by the caller; they are usually embedded in a larger
+ * structure that records what to do on completion. The yaml handle of a
+ * job must not change while the job is in flight.
+ *
+ * The workers run jobs through a backend: "i2c" goes to the hardware
+ * through config-yaml, and "sim" emulates the devices in memory (see
+ * ledd_io_sim.c), for benchmarks and tests on machines without LED
+ * hardware.
+ ***************************************************************************/
+
+#ifndef _LEDD_IO_H_
+#define _LEDD_IO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config-yaml.h"
+#include "dynamic-string.h"
+
+#define LEDD_IO_MAX_BYTES 32    /*!< Largest transfer, as for SMBus blocks */
+
+/************************************************************************//**
+ * ENUM of the operations a bus I/O job can do.
+ ***************************************************************************/
+enum ledd_io_op {
+    LEDD_IO_READ,                       /*!< Read byte_count bytes */
+    LEDD_IO_WRITE                       /*!< Write byte_count bytes */
+};
+
+/************************************************************************//**
+ * STRUCT describing one bus transaction. The caller fills in everything
+ * but rc, which is set by the worker before the job is handed back.
+ ***************************************************************************/
+struct ledd_io_job {
+    enum ledd_io_op op;                 /*!< Read or write */
+    YamlConfigHandle handle;            /*!< Subsystem yaml handle */
+    const char *yaml_name;              /*!< Subsystem name in the handle */
+    char *subsystem;                    /*!< Subsystem name, owned by job */
+    const YamlDevice *yaml_device;      /*!< Device access information */
+    const char *device;                 /*!< Device name */
+    uint32_t reg;                       /*!< First register address */
+    uint32_t byte_count;                /*!< Bytes to transfer */
+    unsigned char data[LEDD_IO_MAX_BYTES]; /*!< Data, little endian */
+    int rc;                             /*!< Result: 0, or the i2c error */
+};
+
+/************************************************************************//**
+ * STRUCT of an LED I/O backend. execute() is called from the bus worker
+ * threads, concurrently for different buses; the other functions are
+ * called from the main thread.
+ ***************************************************************************/
+struct ledd_io_backend {
+    const char *name;                   /*!< Name, as given to --led-io */
+
+    /* Applies "key=value,..." options. Returns NULL, or an error message
+       to be freed by the caller. */
+    char *(*configure)(const char *options);
+
+    /* Runs a job. Returns 0, or an error code. */
+    int (*execute)(struct ledd_io_job *job);
+
+    /* Adds the state of the backend to ds, in full if verbose is set. */
+    void (*show)(struct ds *ds, bool verbose);
+};
+
+extern const struct ledd_io_backend ledd_io_sim_backend;
+
+char *ledd_io_init(const char *backend);
+void ledd_io_exit(void);
+char *ledd_io_configure(const char *options);
+void ledd_io_show(struct ds *ds);
+
+bool ledd_io_submit(struct ledd_io_job *job);
+struct ledd_io_job *ledd_io_poll(void);
+void ledd_io_wait(void);
+
+void ledd_io_dump(struct ds *ds);
+
+#endif /* _LEDD_IO_H_ */
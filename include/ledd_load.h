@@ -0,0 +1,113 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd hardware description loader
+ *
+ * The hardware description files of new subsystems are parsed by a small
+ * pool of threads, so subsystems found together are loaded in parallel.
+ * The main loop picks up loaded subsystems with ledd_load_poll(), and
+ * finishes adding them itself.
+ *
+ * Parsed files are kept in a cache of descriptors, keyed by directory and
+ * by a digest of the files, so subsystems of the same model (same
+ * hw_desc_dir, same file contents) share one yaml handle, parsed once. A
+ * descriptor is immutable once loaded, and is freed when its last user
+ * drops its reference.
+ *
+ * The LED descriptions of a descriptor are compiled into an image (see
+ * ledd_image.h), which is saved so that later starts of ops-ledd map it
+ * instead of parsing led.yaml. devices.yaml is still parsed every time,
+ * since bus access goes through config-yaml.
+ ***************************************************************************/
+
+#ifndef _LEDD_LOAD_H_
+#define _LEDD_LOAD_H_
+
+#include <stdint.h>
+#include "config-yaml.h"
+#include "dynamic-string.h"
+#include "hmap.h"
+#include "ledd_image.h"
+#include "list.h"
+#include "sha1.h"
+
+#define LEDD_LOAD_MAX_THREADS   8       /*!< Largest loader thread pool */
+
+/************************************************************************//**
+ * STRUCT of the times (monotonic, in us) at which the loading of a
+ * subsystem went through each stage.
+ ***************************************************************************/
+struct ledd_load_times {
+    long long int queued;               /*!< Handed to the pool */
+    long long int started;              /*!< Picked up by a thread */
+    long long int hashed;               /*!< Files digested */
+    long long int added;                /*!< yaml_add_subsystem() done */
+    long long int devices;              /*!< yaml_parse_devices() done */
+    long long int leds;                 /*!< LED descriptions compiled */
+    long long int finished;             /*!< LEDs set up by the main loop */
+    long long int published;            /*!< Last LED row committed */
+};
+
+/************************************************************************//**
+ * STRUCT of parsed hardware description files, shared by every subsystem
+ * whose files have the same directory and contents. The yaml data is keyed
+ * by the name of the subsystem it was first loaded for, so yaml and i2c
+ * calls must pass that name rather than the name of the subsystem using it.
+ ***************************************************************************/
+struct ledd_desc {
+    struct hmap_node node;              /*!< In the cache */
+    char *dir;                          /*!< Hardware description directory */
+    uint8_t digest[SHA1_DIGEST_SIZE];   /*!< Digest of the files */
+    char *name;                         /*!< Subsystem name in the handle */
+    YamlConfigHandle handle;            /*!< Parsed files */
+    struct ledd_image *image;           /*!< Compiled LED descriptions */
+    bool from_image;                    /*!< Image mapped, led.yaml unparsed */
+    int ref_cnt;                        /*!< Subsystems and jobs using it */
+    bool loading;                       /*!< Still being parsed */
+    struct ovs_list waiters;            /*!< Loads waiting for the parse */
+};
+
+/************************************************************************//**
+ * STRUCT of the load of one subsystem.
+ ***************************************************************************/
+struct ledd_load {
+    struct ovs_list node;               /*!< In the pool queues */
+    char *name;                         /*!< Subsystem name */
+    char *dir;                          /*!< Hardware description directory */
+    struct ledd_desc *desc;             /*!< Referenced descriptor, if rc 0 */
+    bool shared;                        /*!< Descriptor parsed for another */
+    int rc;                             /*!< 0, or the yaml error */
+    const char *failed;                 /*!< Stage that failed, if any */
+    struct ledd_load_times times;       /*!< Stage times */
+};
+
+void ledd_load_init(int n_threads, const char *image_dir);
+int ledd_load_n_threads(void);
+struct ledd_load *ledd_load_create(const char *name, const char *dir);
+void ledd_load_destroy(struct ledd_load *load);
+void ledd_load_submit(struct ledd_load *load);
+struct ledd_load *ledd_load_poll(void);
+void ledd_load_wait(void);
+
+void ledd_desc_ref(struct ledd_desc *desc);
+void ledd_desc_unref(struct ledd_desc *desc);
+void ledd_desc_dump(struct ds *ds);
+
+#endif /* _LEDD_LOAD_H_ */
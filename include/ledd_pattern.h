@@ -0,0 +1,73 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd LED patterns
+ *
+ * A pattern is a sequence of steps, each turning the LED on or off for
+ * some time, that repeats (or, for a one-shot pattern, runs once and
+ * holds its last step). Patterns are written as, for example:
+ *
+ *     on 100, off 100, on 100, off 700          (heartbeat)
+ *     on 200, off 200, on 200, off 200, once    (two blinks, then off)
+ *
+ * with step times in ms. A pattern is compiled into a step table so the
+ * step at any time is found with a binary search.
+ ***************************************************************************/
+
+#ifndef _LEDD_PATTERN_H_
+#define _LEDD_PATTERN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LEDD_PATTERN_MAX_STEPS  64      /*!< Steps in a pattern */
+#define LEDD_PATTERN_MAX_MS     60000   /*!< Length of a step, in ms */
+
+#define LEDD_PATTERN_DEFAULT    "blink" /*!< Pattern for "flashing" */
+
+/************************************************************************//**
+ * STRUCT of one step of a pattern.
+ ***************************************************************************/
+struct ledd_pattern_step {
+    bool on;                            /*!< LED on, else off */
+    unsigned int end;                   /*!< End of step, in ms from start */
+};
+
+/************************************************************************//**
+ * STRUCT of a compiled pattern.
+ ***************************************************************************/
+struct ledd_pattern {
+    char *name;                         /*!< Pattern name */
+    bool once;                          /*!< Run once, else repeat */
+    unsigned int cycle;                 /*!< Length of the pattern, in ms */
+    size_t n_steps;                     /*!< Number of steps */
+    struct ledd_pattern_step *steps;    /*!< Steps, in order */
+};
+
+struct ledd_pattern *ledd_pattern_parse(const char *name, const char *def,
+                                        char **errorp);
+void ledd_pattern_destroy(struct ledd_pattern *pattern);
+const struct ledd_pattern *ledd_pattern_builtin(const char *name);
+size_t ledd_pattern_step_at(const struct ledd_pattern *pattern,
+                            long long int t, long long int *next);
+bool ledd_pattern_is_blink(const struct ledd_pattern *pattern,
+                           unsigned int *on_ms, unsigned int *off_ms);
+
+#endif /* _LEDD_PATTERN_H_ */
@@ -0,0 +1,70 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd main loop profiler
+ *
+ * The main loop tells the profiler which phase it is entering, and the
+ * time since the last switch is charged to the phase it leaves, so each
+ * pass costs one clock read per phase. Each wakeup is put down to the
+ * causes that the pass found work for (IDL, timer, unixctl or worker
+ * completion), or to "other" if none. The busy time of each pass, from
+ * the return of poll_block() to the next call, is kept in a histogram.
+ ***************************************************************************/
+
+#ifndef _LEDD_PROF_H_
+#define _LEDD_PROF_H_
+
+/************************************************************************//**
+ * ENUM of the phases of the main loop.
+ ***************************************************************************/
+enum ledd_phase {
+    LEDD_PHASE_IDL,                     /*!< ovsdb_idl_run() */
+    LEDD_PHASE_RECONFIGURE,             /*!< ledd_reconfigure() */
+    LEDD_PHASE_BUS,                     /*!< Bus jobs, blink, write batch */
+    LEDD_PHASE_COMMIT,                  /*!< Status transaction */
+    LEDD_PHASE_UNIXCTL,                 /*!< unixctl_server_run() */
+    LEDD_PHASE_OTHER,                   /*!< Anything else, such as waits */
+    LEDD_PHASE_POLL,                    /*!< Blocked in poll_block() */
+    LEDD_NUM_PHASES
+};
+
+/************************************************************************//**
+ * ENUM of the causes of a main loop wakeup.
+ ***************************************************************************/
+enum ledd_wakeup {
+    LEDD_WAKEUP_IDL,                    /*!< DB change or txn result */
+    LEDD_WAKEUP_TIMER,                  /*!< Blink timer expired */
+    LEDD_WAKEUP_UNIXCTL,                /*!< ops-ledd unixctl command */
+    LEDD_WAKEUP_WORKER,                 /*!< Bus job or load completed */
+    LEDD_WAKEUP_OTHER,                  /*!< None of the above */
+    LEDD_NUM_WAKEUPS
+};
+
+struct ds;
+
+void ledd_prof_init(void);
+void ledd_prof_switch(enum ledd_phase phase);
+void ledd_prof_wakeup(enum ledd_wakeup cause);
+unsigned int ledd_prof_end_pass(void);
+void ledd_prof_start_pass(void);
+void ledd_prof_show(struct ds *ds);
+void ledd_prof_reset(void);
+
+#endif /* _LEDD_PROF_H_ */
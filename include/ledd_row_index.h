@@ -0,0 +1,66 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the index of OVSDB LED rows by id
+ *
+ * Both ops-ledd and the LED CLI look LED rows up by led:id, which the
+ * IDL can only do by walking the whole LED table. The index maps each id
+ * to the UUID of its row, so a lookup is a hash lookup of the id followed
+ * by one of the UUID. Keeping UUIDs rather than row pointers means an
+ * entry that has gone stale (its row deleted, or its id changed) is
+ * found out at lookup, and can never point at a freed row.
+ *
+ * The index is either kept up to date from IDL change tracking, with
+ * ledd_row_index_track(), by a process that tracks led:id and clears the
+ * tracked changes itself, or rebuilt whenever the IDL has changed, with
+ * ledd_row_index_refresh().
+ ***************************************************************************/
+
+#ifndef _LEDD_ROW_INDEX_H_
+#define _LEDD_ROW_INDEX_H_
+
+#include <stdbool.h>
+#include "shash.h"
+#include "vswitch-idl.h"
+
+/************************************************************************//**
+ * STRUCT of an index of LED rows by id.
+ ***************************************************************************/
+struct ledd_row_index {
+    struct shash ids;                   /*!< led:id to struct uuid * */
+    unsigned int seqno;                 /*!< IDL seqno the index is for */
+    bool valid;                         /*!< Built at least once */
+};
+
+void ledd_row_index_init(struct ledd_row_index *index);
+void ledd_row_index_destroy(struct ledd_row_index *index);
+void ledd_row_index_rebuild(struct ledd_row_index *index,
+                            const struct ovsdb_idl *idl);
+void ledd_row_index_refresh(struct ledd_row_index *index,
+                            const struct ovsdb_idl *idl);
+void ledd_row_index_track(struct ledd_row_index *index,
+                          const struct ovsdb_idl *idl);
+void ledd_row_index_add(struct ledd_row_index *index,
+                        const struct ovsrec_led *row);
+const struct ovsrec_led *ledd_row_index_find(struct ledd_row_index *index,
+                                             const struct ovsdb_idl *idl,
+                                             const char *id);
+
+#endif /* _LEDD_ROW_INDEX_H_ */
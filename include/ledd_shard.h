@@ -0,0 +1,64 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd shards
+ *
+ * On a modular chassis, the subsystems can be split across several
+ * ops-ledd processes, each given a shard with --shard. A shard is one of:
+ *
+ *     GLOB             the subsystems whose name matches the shell
+ *                      pattern GLOB (e.g. "line_card_[1-4]")
+ *     hash:A-B/N       the subsystems whose name hashes into slots A to B,
+ *                      of N slots; "hash:A/N" is slot A alone
+ *
+ * The shards of the processes must not overlap, and between them should
+ * cover every subsystem. A process with no shard owns every subsystem.
+ *
+ * An OVSDB lock name must be an id ([_a-zA-Z][_a-zA-Z0-9]*), which a shard
+ * usually is not, so the default lock of a shard is named after a hash of
+ * it; the shard itself is only shown in its daemon row and in
+ * ops-ledd/startup.
+ ***************************************************************************/
+
+#ifndef _LEDD_SHARD_H_
+#define _LEDD_SHARD_H_
+
+#include <stdbool.h>
+
+#define LEDD_SHARD_HASH_PREFIX "hash:"  /*!< Prefix of a hash slot shard */
+
+/************************************************************************//**
+ * STRUCT of a shard, the subsystems owned by an ops-ledd process.
+ ***************************************************************************/
+struct ledd_shard {
+    char *spec;                         /*!< As given, or NULL for all */
+    char *pattern;                      /*!< Subsystem name pattern, or NULL */
+    unsigned int first;                 /*!< First hash slot owned */
+    unsigned int last;                  /*!< Last hash slot owned */
+    unsigned int n_slots;               /*!< Hash slots, or 0 */
+};
+
+char *ledd_shard_parse(struct ledd_shard *shard, const char *spec);
+void ledd_shard_destroy(struct ledd_shard *shard);
+bool ledd_shard_owns(const struct ledd_shard *shard, const char *name);
+char *ledd_shard_lock_name(const struct ledd_shard *shard, const char *base);
+bool ledd_shard_is_lock_name(const char *name);
+
+#endif /* _LEDD_SHARD_H_ */
@@ -0,0 +1,75 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd Linux LED class backend
+ *
+ * LEDs driven by a kernel LED class driver are described in led.yaml like
+ * any other LED, with a led_access device of "sysfs:<name>" (an LED under
+ * the LED class directory, /sys/class/leds by default) or "sysfs:<path>"
+ * (an absolute path). The register address and bit mask are not used, and
+ * the on and off settings of the LED type are the brightness to write.
+ *
+ * The brightness and trigger files of the LED are opened once, when its
+ * subsystem is added, and written with pwrite(). A flashing LED is handed
+ * to the kernel "timer" trigger, so no timer runs in ops-ledd; the
+ * delay_on and delay_off files only exist while that trigger is active,
+ * so they are opened each time the LED starts flashing.
+ *
+ * When the LED is opened, its trigger, brightness and (with the timer
+ * trigger) delays are read back, so a restarted ops-ledd only writes the
+ * files whose value it needs to change.
+ ***************************************************************************/
+
+#ifndef _LEDD_SYSFS_H_
+#define _LEDD_SYSFS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LEDD_SYSFS_PREFIX   "sysfs:"            /*!< led_access device prefix */
+#define LEDD_SYSFS_DIR      "/sys/class/leds"   /*!< Default LED class dir */
+
+/************************************************************************//**
+ * STRUCT of an LED class device, with its files kept open.
+ ***************************************************************************/
+struct ledd_sysfs_led {
+    char *path;                         /*!< LED class device directory */
+    int brightness_fd;                  /*!< brightness file */
+    int trigger_fd;                     /*!< trigger file */
+    int delay_on_fd;                    /*!< delay_on file, or -1 */
+    int delay_off_fd;                   /*!< delay_off file, or -1 */
+    bool timer;                         /*!< Timer trigger is active */
+    uint32_t brightness;                /*!< Last brightness written */
+    bool brightness_valid;              /*!< brightness is known */
+    unsigned int delay_on;              /*!< Last delay_on written, in ms */
+    unsigned int delay_off;             /*!< Last delay_off written, in ms */
+    unsigned long long n_writes;        /*!< Attribute writes done */
+};
+
+void ledd_sysfs_set_dir(const char *dir);
+bool ledd_sysfs_is_sysfs(const char *device);
+struct ledd_sysfs_led *ledd_sysfs_open(const char *device);
+void ledd_sysfs_close(struct ledd_sysfs_led *led);
+void ledd_sysfs_refresh(struct ledd_sysfs_led *led);
+int ledd_sysfs_set(struct ledd_sysfs_led *led, uint32_t brightness);
+int ledd_sysfs_blink(struct ledd_sysfs_led *led, uint32_t brightness,
+                     unsigned int delay_on, unsigned int delay_off);
+
+#endif /* _LEDD_SYSFS_H_ */
@@ -0,0 +1,76 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Header for the ops-ledd timer wheel
+ *
+ * A hashed timer wheel: timers are kept in one of LEDD_WHEEL_SLOTS lists,
+ * by expiry tick, so adding, removing and expiring a timer is O(1) and a
+ * wheel with no timers costs nothing. Timers further away than the wheel
+ * span wait in their slot for as many turns as needed.
+ *
+ * Timers are embedded in the structure they schedule; the wheel only
+ * links them.
+ ***************************************************************************/
+
+#ifndef _LEDD_WHEEL_H_
+#define _LEDD_WHEEL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "list.h"
+
+#define LEDD_WHEEL_SLOTS 256    /*!< Slots in the wheel, a power of 2 */
+
+/************************************************************************//**
+ * STRUCT of a timer, embedded in the structure it schedules.
+ ***************************************************************************/
+struct ledd_wheel_timer {
+    struct ovs_list node;               /*!< In a wheel slot */
+    long long int when;                 /*!< Expiry time, in ms */
+};
+
+/************************************************************************//**
+ * STRUCT of a timer wheel.
+ ***************************************************************************/
+struct ledd_wheel {
+    struct ovs_list slots[LEDD_WHEEL_SLOTS]; /*!< Timers, by expiry tick */
+    long long int tick_ms;              /*!< Tick length, in ms */
+    long long int cur_tick;             /*!< First tick not yet expired */
+    size_t n_timers;                    /*!< Timers in the wheel */
+};
+
+void ledd_wheel_init(struct ledd_wheel *wheel, long long int tick_ms);
+void ledd_wheel_add(struct ledd_wheel *wheel, struct ledd_wheel_timer *timer,
+                    long long int when);
+void ledd_wheel_remove(struct ledd_wheel *wheel,
+                       struct ledd_wheel_timer *timer);
+struct ledd_wheel_timer *ledd_wheel_expired(struct ledd_wheel *wheel,
+                                            long long int now);
+long long int ledd_wheel_next(const struct ledd_wheel *wheel);
+void ledd_wheel_wait(const struct ledd_wheel *wheel);
+
+/* True if the timer is in a wheel */
+static inline bool
+ledd_wheel_is_scheduled(const struct ledd_wheel_timer *timer)
+{
+    return(!list_is_empty(&timer->node));
+} /* ledd_wheel_is_scheduled() */
+
+#endif /* _LEDD_WHEEL_H_ */
@@ -107,6 +107,121 @@ def running_config_led(sw1):
     assert led_config_present is True
 
 
+def get_led_state(sw1, led):
+    output = sw1('ovs-vsctl get led {} state'.format(led), shell='bash')
+    return output.strip().strip('"')
+
+
+def init_port_leds(sw1):
+    # Add dummy port LEDs base-port-1 to base-port-4 next to base1.
+    uuid = sw1('ovs-vsctl --bare --columns=_uuid list subsystem',
+               shell='bash').split()[0]
+    for i in range(1, 5):
+        sw1('ovs-vsctl -- add Subsystem {} leds @led -- --id=@led '
+            'create led id=base-port-{} state=off status=ok'
+            .format(uuid, i), shell='bash')
+    return sw1('ovs-vsctl --bare --columns=name list subsystem',
+               shell='bash').split()[0]
+
+
+def led_bulk(sw1, subsystem):
+    sw1('configure terminal')
+    sw1('led base-port-2-3 flashing')
+    for i, state in [(1, 'off'), (2, 'flashing'), (3, 'flashing'),
+                     (4, 'off')]:
+        assert get_led_state(sw1, 'base-port-{}'.format(i)) == state
+
+    sw1('led base-port-* on')
+    for i in range(1, 5):
+        assert get_led_state(sw1, 'base-port-{}'.format(i)) == 'on'
+
+    sw1('led * off')
+    for led in ['base1'] + ['base-port-{}'.format(i) for i in range(1, 5)]:
+        assert get_led_state(sw1, led) == 'off'
+
+    sw1('led subsystem {} flashing'.format(subsystem))
+    for led in ['base1'] + ['base-port-{}'.format(i) for i in range(1, 5)]:
+        assert get_led_state(sw1, led) == 'flashing'
+
+    sw1('no led subsystem {}'.format(subsystem))
+    for led in ['base1'] + ['base-port-{}'.format(i) for i in range(1, 5)]:
+        assert get_led_state(sw1, led) == 'off'
+    sw1('exit')
+
+
+def show_led_filter(sw1, subsystem):
+    # After led_bulk, every LED is off; turn two of them on.
+    sw1('configure terminal')
+    sw1('led base-port-1-2 on')
+    sw1('exit')
+
+    output = sw1('show system led state on')
+    names = [line.split()[0] for line in output.split('\n')
+             if line.startswith('base')]
+    assert names == ['base-port-1', 'base-port-2']
+
+    output = sw1('show system led subsystem {} state off status ok'
+                 .format(subsystem))
+    names = [line.split()[0] for line in output.split('\n')
+             if line.startswith('base')]
+    assert names == ['base-port-3', 'base-port-4', 'base1']
+
+    output = sw1('show system led status fault')
+    assert 'base' not in output
+
+    output = sw1('show system led subsystem no-such-subsystem')
+    assert 'base' not in output
+
+    output = sw1('show system led state dim')
+    assert 'Unknown LED state' in output
+
+
+def show_led_page(sw1, subsystem):
+    output = sw1('show system led subsystem {} lines 2 page 2'
+                 .format(subsystem))
+    names = [line.split()[0] for line in output.split('\n')
+             if line.startswith('base')]
+    assert names == ['base-port-3', 'base-port-4']
+    assert 'Page 2 of 3 (5 LEDs)' in output
+
+    output = sw1('show system led subsystem {} lines 2'.format(subsystem))
+    names = [line.split()[0] for line in output.split('\n')
+             if line.startswith('base')]
+    assert names == ['base-port-1', 'base-port-2']
+
+    output = sw1('show system led subsystem {} page 4 lines 2'
+                 .format(subsystem))
+    assert 'base' not in output
+    assert 'Page 4 of 3' in output
+
+    output = sw1('show system led page 0')
+    assert 'Invalid page' in output
+
+
+def show_led_summary(sw1, subsystem):
+    output = sw1('show system led summary')
+    for line in output.split('\n'):
+        if line.startswith(subsystem):
+            # LEDs, on, off, flashing, ok, fault, uninitialized
+            assert line.split()[1:] == ['5', '2', '3', '0', '5', '0', '0']
+            break
+    else:
+        assert False, output
+
+
+def running_config_led_sorted(sw1):
+    # base-port-1 and base-port-2 are on; the rest are at the default off.
+    sw1('configure terminal')
+    sw1('led base-port-4 flashing')
+    sw1('led base1 on')
+    sw1('exit')
+    output = sw1('show running-config')
+    leds = [line.strip() for line in output.split('\n')
+            if line.strip().startswith('led ')]
+    assert leds == ['led base-port-1 on', 'led base-port-2 on',
+                    'led base-port-4 flashing', 'led base1 on']
+
+
 def test_led_ct_led(topology, step):
     # Initialize the led table with dummy value
     sw1 = topology.get("sw1")
@@ -123,3 +238,16 @@ def test_led_ct_led(topology, step):
     # no led show running-config test
     step('Test to verify show running-config command')
     running_config_led(sw1)
+    # led <range|pattern> and led subsystem <name> test
+    step('Test to verify bulk \'led\' commands')
+    subsystem = init_port_leds(sw1)
+    led_bulk(sw1, subsystem)
+    # show system led filters and summary test
+    step('Test to verify \'show system led\' filters')
+    show_led_filter(sw1, subsystem)
+    step('Test to verify \'show system led\' pages')
+    show_led_page(sw1, subsystem)
+    step('Test to verify \'show system led summary\' command')
+    show_led_summary(sw1, subsystem)
+    step('Test to verify sorted LED show running-config')
+    running_config_led_sorted(sw1)
@@ -0,0 +1,86 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+SAMPLE_SECONDS = 10
+# CPU time, in clock ticks, that ops-ledd may use over the sample while
+# no LED is blinking. An idle daemon must not wake up on a timer.
+MAX_IDLE_TICKS = 5
+
+
+def get_coverage_total(sw1, counter):
+    output = sw1('ovs-appctl -t ops-ledd coverage/show', shell='bash')
+    for line in output.split('\n'):
+        if line.startswith(counter + ' '):
+            return int(line.split('total:')[1].strip())
+    return 0
+
+
+def get_cpu_ticks(sw1):
+    # utime + stime, fields 14 and 15 of /proc/<pid>/stat
+    output = sw1('cat /proc/$(pidof ops-ledd)/stat', shell='bash')
+    fields = output.split(')')[-1].split()
+    return int(fields[11]) + int(fields[12])
+
+
+def set_all_leds_off(sw1):
+    output = sw1('ovs-vsctl --bare --columns=id list led', shell='bash')
+    for led in output.split():
+        sw1('ovs-vsctl set led {} state=off'.format(led), shell='bash')
+
+
+def test_ledd_ct_blink_idle(topology, step):
+    sw1 = topology.get('sw1')
+
+    step('Turn every LED off, so none is blinking')
+    set_all_leds_off(sw1)
+    sleep(2)
+
+    step('Sample ops-ledd CPU usage for {} seconds'.format(SAMPLE_SECONDS))
+    ticks = get_cpu_ticks(sw1)
+    blinks = get_coverage_total(sw1, 'ledd_blink_tick')
+    timer_wakeups = get_coverage_total(sw1, 'ledd_wakeup_timer')
+    sleep(SAMPLE_SECONDS)
+    ticks = get_cpu_ticks(sw1) - ticks
+    blinks = get_coverage_total(sw1, 'ledd_blink_tick') - blinks
+    timer_wakeups = (get_coverage_total(sw1, 'ledd_wakeup_timer')
+                     - timer_wakeups)
+
+    step('ops-ledd used {} CPU ticks, {} blink ticks and {} timer wakeups '
+         'while idle'.format(ticks, blinks, timer_wakeups))
+    assert blinks == 0
+    assert timer_wakeups == 0
+    assert ticks <= MAX_IDLE_TICKS
+
+    step('The main loop profile accounts for the wakeups')
+    output = sw1('ovs-appctl -t ops-ledd ops-ledd/profile', shell='bash')
+    for phase in ['idl_run', 'reconfigure', 'bus', 'commit', 'unixctl',
+                  'poll']:
+        assert phase in output
+    assert 'unixctl' in output.split('Wakeups:')[1].split('\n')[0]
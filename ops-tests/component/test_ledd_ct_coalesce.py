@@ -0,0 +1,89 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+WINDOW_MS = 500
+CHANGES = 20
+
+
+def get_coverage_total(sw1, counter):
+    output = sw1('ovs-appctl -t ops-ledd coverage/show', shell='bash')
+    for line in output.split('\n'):
+        if line.startswith(counter + ' '):
+            return int(line.split('total:')[1].strip())
+    return 0
+
+
+def flip_led(sw1, led, times):
+    # One transaction per change, back to back, as automation would do.
+    sw1('for i in $(seq {0}); do '
+        'ovs-vsctl set led {1} state=on; '
+        'ovs-vsctl set led {1} state=off; done'
+        .format(times // 2, led), shell='bash')
+
+
+def test_ledd_ct_coalesce(topology, step):
+    sw1 = topology.get('sw1')
+
+    subsystem = sw1('ovs-vsctl --bare --columns=name list subsystem',
+                    shell='bash').split()[0]
+    led = sw1('ovs-vsctl --bare --columns=id list led',
+              shell='bash').split()[0]
+
+    step('Set a {} ms coalescing window on subsystem {}'
+         .format(WINDOW_MS, subsystem))
+    sw1('ovs-vsctl set subsystem {} other_config:led_coalesce_window={} '
+        'other_config:led_coalesce_max={}'
+        .format(subsystem, WINDOW_MS, 10 * WINDOW_MS), shell='bash')
+    sleep(1)
+
+    step('Make {} changes to LED {}, one transaction each'
+         .format(CHANGES, led))
+    passes = get_coverage_total(sw1, 'ledd_reconfigure')
+    held = get_coverage_total(sw1, 'ledd_coalesced')
+    flip_led(sw1, led, CHANGES)
+    sleep(1 + 10 * WINDOW_MS / 1000.0)
+    held = get_coverage_total(sw1, 'ledd_coalesced') - held
+    passes = get_coverage_total(sw1, 'ledd_reconfigure') - passes
+
+    step('{} passes, {} held'.format(passes, held))
+    assert held > 0
+    out = sw1('ovs-vsctl get led {} state'.format(led), shell='bash')
+    assert 'off' in out
+
+    step('A single change is applied right away')
+    sleep(2 * WINDOW_MS / 1000.0)
+    held = get_coverage_total(sw1, 'ledd_coalesced')
+    sw1('ovs-vsctl set led {} state=on'.format(led), shell='bash')
+    sleep(0.1)
+    assert get_coverage_total(sw1, 'ledd_coalesced') == held
+    sw1('ovs-vsctl set led {} state=off'.format(led), shell='bash')
+
+    sw1('ovs-vsctl remove subsystem {} other_config led_coalesce_window '
+        'led_coalesce_max'.format(subsystem), shell='bash')
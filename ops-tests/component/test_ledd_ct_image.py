@@ -0,0 +1,77 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+IMAGE_DIR = '/var/run/ops-ledd'
+RESTARTS = 3
+
+
+def restart_ledd(sw1):
+    sw1('systemctl restart ops-ledd', shell='bash')
+    for _ in range(30):
+        sleep(1)
+        out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+        if 'Time to first LED: -' not in out and '(loading)' not in out:
+            return out
+    assert False, 'ops-ledd did not come back up'
+
+
+def get_led_times(out):
+    # Returns {subsystem: (source, ms spent on the LED descriptions)}.
+    times = {}
+    started = False
+    for line in out.split('\n'):
+        if line.startswith('Subsystem'):
+            started = True
+        elif started and line.strip():
+            fields = line.split()
+            source = 'image' if '(image)' in line else 'yaml'
+            times[fields[0]] = (source, fields[5])
+    return times
+
+
+def test_ledd_ct_image(topology, step):
+    sw1 = topology.get('sw1')
+
+    yaml_ms = []
+    image_ms = []
+    for _ in range(RESTARTS):
+        step('Start ops-ledd without saved LED images')
+        sw1('rm -f {}/*.img'.format(IMAGE_DIR), shell='bash')
+        for source, ms in get_led_times(restart_ledd(sw1)).values():
+            assert source == 'yaml'
+            yaml_ms.append(ms)
+
+        step('Start ops-ledd again, from the images it saved')
+        for source, ms in get_led_times(restart_ledd(sw1)).values():
+            assert source == 'image'
+            image_ms.append(ms)
+
+    step('LED descriptions took {} ms from yaml and {} ms from images'
+         .format(', '.join(yaml_ms), ', '.join(image_ms)))
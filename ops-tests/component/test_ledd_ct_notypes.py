@@ -0,0 +1,103 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+# A subsystem whose led.yaml has an LED but no LED types, so it can not
+# be set up.
+HW_DESC_DIR = '/tmp/ledd_notypes_hw'
+SUBSYSTEM = 'notypes_test'
+
+MANIFEST_YAML = """---
+version: 0.1.0
+devices: devices.yaml
+led: led.yaml
+"""
+
+DEVICES_YAML = """---
+devices:
+  - name: cpld0
+    bus: i2c-0
+    dev_type: cpld
+    address: 0x40
+"""
+
+LED_YAML = """---
+led_info:
+  number_types: 0
+  number_leds: 1
+leds:
+  - name: loc
+    type: loc
+    led_access:
+      device: cpld0
+      register_address: 0x10
+      register_size: 1
+      bit_mask: 0x03
+"""
+
+
+def write_file(sw1, path, text):
+    sw1("cat > {} << 'EOF'\n{}EOF".format(path, text), shell='bash')
+
+
+def ledd_pid(sw1):
+    return sw1('cat /var/run/openvswitch/ops-ledd.pid', shell='bash').strip()
+
+
+def test_ledd_ct_notypes(topology, step):
+    sw1 = topology.get('sw1')
+    pid = ledd_pid(sw1)
+
+    step('Add a subsystem with an LED but no LED types')
+    sw1('mkdir -p {}'.format(HW_DESC_DIR), shell='bash')
+    write_file(sw1, HW_DESC_DIR + '/manifest.yaml', MANIFEST_YAML)
+    write_file(sw1, HW_DESC_DIR + '/devices.yaml', DEVICES_YAML)
+    write_file(sw1, HW_DESC_DIR + '/led.yaml', LED_YAML)
+    sw1('ovsdb-client transact \'["OpenSwitch", {{"op": "insert", '
+        '"table": "Subsystem", "row": {{"name": "{}", '
+        '"hw_desc_dir": "{}"}}}}]\''.format(SUBSYSTEM, HW_DESC_DIR),
+        shell='bash')
+    sleep(3)
+
+    # The subsystem is retried on every pass, and removed each time.
+    step('Check that ops-ledd is still running, and drives no LED for it')
+    assert ledd_pid(sw1) == pid
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+    assert 'Loader threads:' in out
+    out = sw1('ovs-vsctl --bare --columns=id find led id={}-loc'
+              .format(SUBSYSTEM), shell='bash')
+    assert out.strip() == ''
+
+    step('Remove the subsystem, and check ops-ledd is still running')
+    sw1('ovsdb-client transact \'["OpenSwitch", {{"op": "delete", '
+        '"table": "Subsystem", "where": [["name", "==", "{}"]]}}]\''
+        .format(SUBSYSTEM), shell='bash')
+    sleep(1)
+    assert ledd_pid(sw1) == pid
+    sw1('rm -rf {}'.format(HW_DESC_DIR), shell='bash')
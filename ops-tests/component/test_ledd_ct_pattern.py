@@ -0,0 +1,100 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+
+def get_dump(sw1):
+    return sw1('ovs-appctl -t ops-ledd ops-ledd/dump', shell='bash')
+
+
+def get_first_led(sw1):
+    # Returns (subsystem, LED name) of the first LED managed by ops-ledd.
+    subsystem = None
+    for line in get_dump(sw1).split('\n'):
+        if line.startswith('Subsystem:'):
+            subsystem = line.split(':')[1].strip()
+        elif 'LED name:' in line and subsystem is not None:
+            return subsystem, line.split(':')[1].strip()
+    return None, None
+
+
+def get_led_pattern(sw1, led):
+    found = False
+    for line in get_dump(sw1).split('\n'):
+        if 'LED name:' in line:
+            found = line.split(':')[1].strip() == led
+        elif found and 'LED pattern:' in line:
+            return line.split(':')[1].strip()
+        elif found and 'LED status:' in line:
+            return None
+    return None
+
+
+def set_subsystem_key(sw1, subsystem, key, value):
+    sw1('ovs-vsctl set subsystem {} \'other_config:"{}"="{}"\''
+        .format(subsystem, key, value), shell='bash')
+
+
+def test_ledd_ct_pattern(topology, step):
+    sw1 = topology.get('sw1')
+
+    subsystem, led = get_first_led(sw1)
+    if led is None:
+        step('No LED managed by ops-ledd, nothing to test')
+        return
+    short_name = led[len(subsystem) + 1:]
+
+    step('Select the heartbeat pattern for LED {}'.format(led))
+    set_subsystem_key(sw1, subsystem, 'led:' + short_name, 'heartbeat')
+    sw1('ovs-vsctl set led {} state=flashing'.format(led), shell='bash')
+    sleep(2)
+    assert get_led_pattern(sw1, led) == 'heartbeat'
+
+    step('Define and select a custom pattern')
+    set_subsystem_key(sw1, subsystem, 'led_pattern:twice',
+                      'on 200, off 200, on 200, off 200, once')
+    set_subsystem_key(sw1, subsystem, 'led:' + short_name, 'twice')
+    sleep(2)
+    assert get_led_pattern(sw1, led) == 'twice'
+
+    step('Verify an invalid pattern is ignored')
+    set_subsystem_key(sw1, subsystem, 'led_pattern:bad', 'on, off 100')
+    set_subsystem_key(sw1, subsystem, 'led:' + short_name, 'bad')
+    sleep(2)
+    assert get_led_pattern(sw1, led) is None
+
+    step('Verify the pattern stops when the LED is turned off')
+    set_subsystem_key(sw1, subsystem, 'led:' + short_name, 'heartbeat')
+    sw1('ovs-vsctl set led {} state=off'.format(led), shell='bash')
+    sleep(2)
+    assert get_led_pattern(sw1, led) is None
+
+    sw1('ovs-vsctl remove subsystem {} other_config "led:{}" '
+        '"led_pattern:twice" "led_pattern:bad"'.format(subsystem, short_name),
+        shell='bash')
@@ -0,0 +1,101 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+NUM_SCALE_LEDS = 500
+LEDS_PER_COMMAND = 100
+
+
+def get_subsystem_uuid(sw1):
+    output = sw1('list subsystem', shell='vsctl')
+    for line in output.split('\n'):
+        if '_uuid' in line:
+            return line.split(':')[1].strip()
+    return None
+
+
+def add_scale_leds(sw1, uuid):
+    # Add LED rows that ops-ledd does not own. They are referenced by
+    # the subsystem so they are not garbage collected.
+    for first in range(0, NUM_SCALE_LEDS, LEDS_PER_COMMAND):
+        cmd = 'ovs-vsctl'
+        for i in range(first, first + LEDS_PER_COMMAND):
+            cmd += (' -- --id=@led{0} create led id=scale{0} state=off'
+                    ' status=ok -- add subsystem {1} leds @led{0}'
+                    .format(i, uuid))
+        sw1(cmd, shell='bash')
+
+
+def del_scale_leds(sw1, uuid):
+    for i in range(NUM_SCALE_LEDS):
+        sw1('ovs-vsctl remove subsystem {} leds '
+            '$(ovs-vsctl get led scale{} _uuid)'.format(uuid, i),
+            shell='bash')
+
+
+def get_coverage_total(sw1, counter):
+    output = sw1('ovs-appctl -t ops-ledd coverage/show', shell='bash')
+    for line in output.split('\n'):
+        if line.startswith(counter + ' '):
+            return int(line.split('total:')[1].strip())
+    return 0
+
+
+def changed_rows_for(sw1, cmd):
+    before = get_coverage_total(sw1, 'ledd_led_row_change')
+    sw1(cmd, shell='bash')
+    sleep(2)
+    return get_coverage_total(sw1, 'ledd_led_row_change') - before
+
+
+def test_ledd_ct_scale(topology, step):
+    sw1 = topology.get('sw1')
+    uuid = get_subsystem_uuid(sw1)
+    assert uuid is not None
+
+    step('Add {} LED rows'.format(NUM_SCALE_LEDS))
+    add_scale_leds(sw1, uuid)
+    sleep(2)
+
+    # A single state change must only be processed once, no matter how
+    # many LED rows are in the table.
+    step('Verify a single LED change processes a single row')
+    changed = changed_rows_for(sw1, 'ovs-vsctl set led scale1 state=on')
+    assert changed == 1
+
+    step('Verify a two-LED change processes two rows')
+    changed = changed_rows_for(sw1, 'ovs-vsctl set led scale2 state=on -- '
+                                    'set led scale3 state=on')
+    assert changed == 2
+
+    step('Verify a status-only change processes no rows')
+    changed = changed_rows_for(sw1, 'ovs-vsctl set led scale4 status=fault')
+    assert changed == 0
+
+    del_scale_leds(sw1, uuid)
@@ -0,0 +1,118 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+# Two shards, splitting the subsystems by the hash of their name.
+SHARDS = ['hash:0/2', 'hash:1/2']
+RUNDIR = '/var/run/openvswitch'
+
+
+def shard_ctl(idx):
+    return '{}/ops-ledd-shard{}.ctl'.format(RUNDIR, idx)
+
+
+def shard_startup(sw1, idx):
+    return sw1('ovs-appctl -t {} ops-ledd/startup'.format(shard_ctl(idx)),
+               shell='bash')
+
+
+def shard_subsystems(out):
+    lines = out.split('\n')
+    start = [i for i, l in enumerate(lines)
+             if l.startswith('Subsystem (ms)')][0]
+    return [l.split()[0] for l in lines[start + 1:] if l.strip()]
+
+
+def test_ledd_ct_shard(topology, step):
+    sw1 = topology.get('sw1')
+
+    subsystems = sw1('ovs-vsctl --bare --columns=name list subsystem',
+                     shell='bash').split()
+
+    step('Replace ops-ledd with two shards')
+    sw1('systemctl stop ops-ledd', shell='bash')
+    for idx, shard in enumerate(SHARDS):
+        sw1('ops-ledd --shard={} --shards={} --detach --no-chdir '
+            '--pidfile={}/ops-ledd-shard{}.pid --unixctl={}'
+            .format(shard, ','.join(SHARDS), RUNDIR, idx, shard_ctl(idx)),
+            shell='bash')
+
+    step('Check that each shard is ready, and that both are counted')
+    for idx in range(len(SHARDS)):
+        for _ in range(30):
+            out = shard_startup(sw1, idx)
+            if 'Shards ready: {0} of {0}'.format(len(SHARDS)) in out:
+                break
+            sleep(1)
+        else:
+            assert False, 'shard {} was not ready'.format(SHARDS[idx])
+        # The lock is named after a hash of the shard, which is shown.
+        assert 'Lock: held (ops_ledd_shard_' in out
+        assert 'Shard: {},'.format(SHARDS[idx]) in out
+        assert ', ready' in out
+
+    step('Check that the shards split the subsystems between them')
+    owned = []
+    for idx in range(len(SHARDS)):
+        owned += shard_subsystems(shard_startup(sw1, idx))
+    assert sorted(owned) == sorted(subsystems)
+
+    step('Check that cur_hw is set')
+    out = sw1('ovs-vsctl --bare --columns=cur_hw find daemon name=ops-ledd',
+              shell='bash')
+    assert out.strip() == '1'
+
+    step('Check that the LEDs of every shard are driven')
+    leds = sw1('ovs-vsctl --bare --columns=id list led',
+               shell='bash').split()
+    for led in leds:
+        sw1('ovs-vsctl set led {} state=on'.format(led), shell='bash')
+    sleep(1)
+    for led in leds:
+        out = sw1('ovs-vsctl get led {} status'.format(led), shell='bash')
+        assert 'ok' in out
+        sw1('ovs-vsctl set led {} state=off'.format(led), shell='bash')
+
+    # A shard that exits no longer counts as ready.
+    step('Stop the shards, and check they clear their daemon rows')
+    for idx, shard in enumerate(SHARDS):
+        sw1('ovs-appctl -t {} exit'.format(shard_ctl(idx)), shell='bash')
+        out = sw1('ovs-vsctl --bare --columns=cur_hw find daemon '
+                  'name="ops-ledd:{}"'.format(shard), shell='bash')
+        assert out.strip() == '0'
+
+    step('Remove the daemon rows, and restart the ops-ledd service')
+    for shard in SHARDS:
+        sw1('ovsdb-client transact \'["OpenSwitch", {{"op": "delete", '
+            '"table": "Daemon", "where": [["name", "==", '
+            '"ops-ledd:{}"]]}}]\''.format(shard), shell='bash')
+    sw1('systemctl start ops-ledd', shell='bash')
+    sleep(3)
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+    assert 'Lock: held (ops_ledd)' in out
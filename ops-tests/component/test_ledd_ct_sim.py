@@ -0,0 +1,244 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+RUNDIR = '/var/run/openvswitch'
+PIDFILE = RUNDIR + '/ops-ledd-sim.pid'
+CTL = RUNDIR + '/ops-ledd-sim.ctl'
+HW_DESC_DIR = '/tmp/ledd_sim_hw'
+SUBSYSTEM = 'sim_test'
+
+# Two devices on two buses. LEDs a and b share register 0x10 of dev0,
+# c is in the next register, and d is on dev1. Device and bus names are
+# unique, so the transactions of this subsystem are told apart from
+# those of the other subsystems in the log.
+DEV0 = 'simtest_dev0'
+DEV1 = 'simtest_dev1'
+BUS0 = 'simtest-i2c-0'
+BUS1 = 'simtest-i2c-1'
+
+MANIFEST_YAML = """---
+version: 0.1.0
+devices: devices.yaml
+led: led.yaml
+"""
+
+DEVICES_YAML = """---
+devices:
+  - name: {}
+    bus: {}
+    dev_type: cpld
+    address: 0x40
+  - name: {}
+    bus: {}
+    dev_type: cpld
+    address: 0x41
+""".format(DEV0, BUS0, DEV1, BUS1)
+
+LED_YAML = """---
+led_info:
+  number_types: 1
+  number_leds: 4
+led_types:
+  - type: loc
+    settings:
+      on: 1
+      off: 0
+      flashing: 2
+leds:
+  - name: a
+    type: loc
+    led_access:
+      device: {0}
+      register_address: 0x10
+      register_size: 1
+      bit_mask: 0x03
+  - name: b
+    type: loc
+    led_access:
+      device: {0}
+      register_address: 0x10
+      register_size: 1
+      bit_mask: 0x0c
+  - name: c
+    type: loc
+    led_access:
+      device: {0}
+      register_address: 0x11
+      register_size: 1
+      bit_mask: 0x03
+  - name: d
+    type: loc
+    led_access:
+      device: {1}
+      register_address: 0x10
+      register_size: 1
+      bit_mask: 0x03
+""".format(DEV0, DEV1)
+
+
+def write_file(sw1, path, text):
+    sw1("cat > {} << 'EOF'\n{}EOF".format(path, text), shell='bash')
+
+
+def led(name):
+    return '{}-{}'.format(SUBSYSTEM, name)
+
+
+def io_backend(sw1, options=''):
+    return sw1('ovs-appctl -t {} ops-ledd/io-backend {}'.format(CTL, options),
+               shell='bash')
+
+
+def sim_log(sw1):
+    # (op, device, register, data bytes, failed) of each transaction on
+    # the devices of this test, oldest first
+    entries = []
+    out = io_backend(sw1)
+    lines = out.split('Sim transaction log')[1].split('\n')[1:]
+    for line in lines:
+        fields = line.split()
+        if len(fields) < 4 or fields[2] not in (DEV0, DEV1):
+            continue
+        failed = 'failed' in fields
+        if failed:
+            fields = fields[:fields.index('failed')]
+        entries.append((fields[1], fields[2], int(fields[3], 16),
+                        [f for f in fields[4:] if f != '...'], failed))
+    return entries
+
+
+def bus_jobs(sw1, bus):
+    out = sw1('ovs-appctl -t {} ops-ledd/dump'.format(CTL), shell='bash')
+    for line in out.split('\n'):
+        if line.startswith('Bus {}:'.format(bus)):
+            return int(line.split()[2])
+    return 0
+
+
+def set_leds(sw1, **states):
+    # all the changes in one transaction, applied in one pass
+    sw1('ovs-vsctl ' + ' -- '.join('set led {} state={}'.format(led(n), s)
+                                   for n, s in sorted(states.items())),
+        shell='bash')
+    sleep(1)
+
+
+def led_status(sw1, name):
+    return sw1('ovs-vsctl get led {} status'.format(led(name)),
+               shell='bash').strip().strip('"')
+
+
+def test_ledd_ct_sim(topology, step):
+    sw1 = topology.get('sw1')
+
+    step('Replace ops-ledd with one on the sim backend')
+    sw1('systemctl stop ops-ledd', shell='bash')
+    sw1('ops-ledd --led-io=sim:log_size=65536 --detach --no-chdir '
+        '--pidfile={} --unixctl={}'.format(PIDFILE, CTL), shell='bash')
+    for _ in range(30):
+        sleep(1)
+        out = sw1('ovs-appctl -t {} ops-ledd/startup'.format(CTL),
+                  shell='bash')
+        if 'Lock: held' in out and '(loading)' not in out:
+            break
+    else:
+        assert False, 'ops-ledd did not come up on the sim backend'
+    assert 'LED I/O backend: sim' in io_backend(sw1)
+
+    step('Add a subsystem with LEDs on two simulated buses')
+    io_backend(sw1, 'reset')
+    sw1('mkdir -p {}'.format(HW_DESC_DIR), shell='bash')
+    write_file(sw1, HW_DESC_DIR + '/manifest.yaml', MANIFEST_YAML)
+    write_file(sw1, HW_DESC_DIR + '/devices.yaml', DEVICES_YAML)
+    write_file(sw1, HW_DESC_DIR + '/led.yaml', LED_YAML)
+    sw1('ovsdb-client transact \'["OpenSwitch", {{"op": "insert", '
+        '"table": "Subsystem", "row": {{"name": "{}", '
+        '"hw_desc_dir": "{}"}}}}]\''.format(SUBSYSTEM, HW_DESC_DIR),
+        shell='bash')
+    sleep(3)
+    for name in 'abcd':
+        assert led_status(sw1, name) == 'ok'
+
+    # The simulated registers read as zero, the value of every LED off,
+    # so bring-up reads each register once and writes nothing.
+    step('Check that bring-up reads each register once and avoids writes')
+    log = sim_log(sw1)
+    reads = sorted((e[1], e[2]) for e in log if e[0] == 'read')
+    assert reads == [(DEV0, 0x10), (DEV0, 0x11), (DEV1, 0x10)], log
+    assert [e for e in log if e[0] == 'write'] == [], log
+
+    step('Check that LEDs sharing a register are written together')
+    io_backend(sw1, 'reset')
+    set_leds(sw1, a='on', b='flashing')
+    log = sim_log(sw1)
+    # a is 0x01 in bits 0-1, b is 0x02 in bits 2-3; no read, the shadow
+    # register has the other bits
+    assert log == [('write', DEV0, 0x10, ['09'], False)], log
+
+    step('Check that consecutive registers take one block write')
+    io_backend(sw1, 'reset')
+    set_leds(sw1, b='off', c='on')
+    log = sim_log(sw1)
+    assert log == [('write', DEV0, 0x10, ['01', '01'], False)], log
+
+    step('Check that each bus has a worker of its own')
+    jobs0 = bus_jobs(sw1, BUS0)
+    jobs1 = bus_jobs(sw1, BUS1)
+    set_leds(sw1, d='on')
+    assert sim_log(sw1)[-1] == ('write', DEV1, 0x10, ['01'], False)
+    assert bus_jobs(sw1, BUS0) == jobs0
+    assert bus_jobs(sw1, BUS1) == jobs1 + 1
+
+    step('Fail the second device, and check its LED goes to fault')
+    io_backend(sw1, 'fail_device={}'.format(DEV1))
+    set_leds(sw1, d='flashing')
+    assert sim_log(sw1)[-1] == ('write', DEV1, 0x10, ['02'], True)
+    assert led_status(sw1, 'd') == 'fault'
+    # LEDs on the other bus are not held up by the failing device
+    set_leds(sw1, a='off')
+    assert led_status(sw1, 'a') == 'ok'
+
+    step('Clear the failure, and check the LED recovers')
+    io_backend(sw1, 'fail_device=')
+    set_leds(sw1, d='off')
+    assert sim_log(sw1)[-1] == ('write', DEV1, 0x10, ['00'], False)
+    assert led_status(sw1, 'd') == 'ok'
+
+    step('Remove the subsystem, and restart the ops-ledd service')
+    sw1('ovsdb-client transact \'["OpenSwitch", {{"op": "delete", '
+        '"table": "Subsystem", "where": [["name", "==", "{}"]]}}]\''
+        .format(SUBSYSTEM), shell='bash')
+    sleep(1)
+    sw1('kill $(cat {})'.format(PIDFILE), shell='bash')
+    sw1('rm -rf {}'.format(HW_DESC_DIR), shell='bash')
+    sw1('systemctl start ops-ledd', shell='bash')
+    sleep(3)
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+    assert 'Lock: held' in out
@@ -0,0 +1,102 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep, time
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+STANDBY_PIDFILE = '/var/run/openvswitch/ops-ledd-standby.pid'
+STANDBY_CTL = '/var/run/openvswitch/ops-ledd-standby.ctl'
+
+# The time from the lock being acquired to the LED changes being written
+# and their transaction sent, as measured by ops-ledd.
+MAX_TAKEOVER_MS = 100
+
+
+def standby_startup(sw1):
+    return sw1('ovs-appctl -t {} ops-ledd/startup'.format(STANDBY_CTL),
+               shell='bash')
+
+
+def takeover_ms(out):
+    line = [l for l in out.split('\n') if l.startswith('Last takeover:')][0]
+    return float(line.split()[2])
+
+
+def test_ledd_ct_standby(topology, step):
+    sw1 = topology.get('sw1')
+
+    step('Start a second ops-ledd as a hot standby')
+    sw1('ops-ledd --hot-standby --detach --no-chdir --pidfile={} '
+        '--unixctl={}'.format(STANDBY_PIDFILE, STANDBY_CTL), shell='bash')
+    for _ in range(30):
+        sleep(1)
+        out = standby_startup(sw1)
+        if ('Lock: standing by' in out and '(loading)' not in out
+                and 'Time to first LED: -' not in out):
+            break
+    else:
+        assert False, 'the standby did not load the subsystems'
+    assert 'Last takeover: -' in out
+
+    # The standby follows the db, without writing to it.
+    step('Change an LED, and check the standby follows it')
+    led = sw1('ovs-vsctl --bare --columns=id list led',
+              shell='bash').split()[0]
+    sw1('ovs-vsctl set led {} state=on'.format(led), shell='bash')
+    sleep(1)
+    out = sw1('ovs-appctl -t {} ops-ledd/dump'.format(STANDBY_CTL),
+              shell='bash')
+    assert 'LED state: on' in out
+
+    step('Kill the active ops-ledd, and time the takeover')
+    start = time()
+    sw1('systemctl kill -s KILL ops-ledd', shell='bash')
+    for _ in range(100):
+        out = standby_startup(sw1)
+        if 'Lock: held' in out:
+            break
+        sleep(0.1)
+    else:
+        assert False, 'the standby did not take over'
+    elapsed = (time() - start) * 1000
+    ms = takeover_ms(out)
+    print('takeover: {:.1f} ms in ops-ledd, {:.0f} ms from the kill'
+          .format(ms, elapsed))
+    assert ms < MAX_TAKEOVER_MS
+
+    step('Check that the new active ops-ledd drives the LEDs')
+    sw1('ovs-vsctl set led {} state=off'.format(led), shell='bash')
+    sleep(1)
+    out = sw1('ovs-vsctl get led {} status'.format(led), shell='bash')
+    assert 'ok' in out
+
+    step('Stop the standby, and restart the ops-ledd service')
+    sw1('kill $(cat {})'.format(STANDBY_PIDFILE), shell='bash')
+    sw1('systemctl restart ops-ledd', shell='bash')
+    sleep(3)
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+    assert 'Lock: held' in out
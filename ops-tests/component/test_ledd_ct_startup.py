@@ -0,0 +1,61 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+
+def test_ledd_ct_startup(topology, step):
+    sw1 = topology.get('sw1')
+
+    step('Get the startup timing of ops-ledd')
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+    assert 'Loader threads:' in out
+    assert 'Time to first LED:' in out
+
+    step('Check that every subsystem was loaded')
+    subsystems = sw1('ovs-vsctl --bare --columns=name list subsystem',
+                     shell='bash').split()
+    lines = out.split('\n')
+    for subsystem in subsystems:
+        rows = [l for l in lines if l.split(' ')[0] == subsystem]
+        assert len(rows) == 1
+        assert '(loading)' not in rows[0]
+
+    # The subsystems are up, so their LED rows are all published, in one
+    # or more chunks.
+    step('Check that every subsystem was published')
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+    lines = out.split('\n')
+    header = [l for l in lines if l.startswith('Subsystem (ms)')][0]
+    publish = header.split().index('publish') - 1
+    for subsystem in subsystems:
+        row = [l for l in lines if l.split(' ')[0] == subsystem][0]
+        if '(failed)' in row:
+            continue
+        assert row.split()[publish] != '-'
+        leds = sw1('ovs-vsctl get subsystem {} leds'.format(subsystem),
+                   shell='bash')
+        assert leds.strip() != '[]'
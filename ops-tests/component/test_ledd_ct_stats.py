@@ -0,0 +1,75 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+CHANGES = 10
+STAGES = ['dispatch', 'write', 'commit', 'total']
+
+
+def get_stats(sw1):
+    # Returns {stage: (count, p50, max)} over all subsystems: the (all) rows
+    # come last, if there is more than one subsystem.
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/stats', shell='bash')
+    stats = {}
+    for line in out.split('\n'):
+        fields = line.split()
+        for stage in STAGES:
+            if stage in fields:
+                i = fields.index(stage)
+                stats[stage] = (int(fields[i + 1]), int(fields[i + 4]),
+                                int(fields[i + 8]))
+    return stats
+
+
+def test_ledd_ct_stats(topology, step):
+    sw1 = topology.get('sw1')
+
+    output = sw1('ovs-vsctl --bare --columns=id list led', shell='bash')
+    led = output.split()[0]
+
+    step('Reset the latency stats')
+    sw1('ovs-vsctl set led {} state=off'.format(led), shell='bash')
+    sleep(1)
+    sw1('ovs-appctl -t ops-ledd ops-ledd/stats reset', shell='bash')
+    for count, _, _ in get_stats(sw1).values():
+        assert count == 0
+
+    step('Change the state of LED {} {} times'.format(led, CHANGES))
+    for i in range(CHANGES):
+        state = 'off' if i % 2 else 'on'
+        sw1('ovs-vsctl set led {} state={}'.format(led, state), shell='bash')
+        sleep(0.5)
+
+    step('Every change is timed in every stage')
+    stats = get_stats(sw1)
+    for stage in STAGES:
+        count, p50, max_ = stats[stage]
+        assert count == CHANGES
+        assert p50 <= max_
+    assert stats['total'][2] >= stats['write'][2]
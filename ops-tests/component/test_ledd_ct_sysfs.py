@@ -0,0 +1,156 @@
+# -*- coding: utf-8 -*-
+
+# (c) Copyright 2016 Hewlett Packard Enterprise Development LP
+#
+# GNU Zebra is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2, or (at your option) any
+# later version.
+#
+# GNU Zebra is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Zebra; see the file COPYING.  If not, write to the Free
+# Software Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+# 02111-1307, USA.
+
+from time import sleep
+
+TOPOLOGY = """
+# +-------+
+# |  sw1  |
+# +-------+
+
+# Nodes
+[type=openswitch name="Switch 1"] sw1
+"""
+
+# A fake LED class tree in a tmpfs, and a subsystem whose LED is in it.
+SYSFS_DIR = '/tmp/ledd_sysfs'
+HW_DESC_DIR = '/tmp/ledd_sysfs_hw'
+SUBSYSTEM = 'sysfs_test'
+LED = '{}-loc'.format(SUBSYSTEM)
+
+MANIFEST_YAML = """---
+version: 0.1.0
+devices: devices.yaml
+led: led.yaml
+"""
+
+DEVICES_YAML = """---
+devices:
+  - name: cpld0
+    bus: i2c-0
+    dev_type: cpld
+    address: 0x40
+"""
+
+LED_YAML = """---
+led_info:
+  number_types: 1
+  number_leds: 1
+led_types:
+  - type: loc
+    settings:
+      on: 255
+      off: 0
+      flashing: 255
+leds:
+  - name: loc
+    type: loc
+    led_access:
+      device: sysfs:{}/loc
+      register_address: 0
+      register_size: 1
+      bit_mask: 0
+""".format(SYSFS_DIR)
+
+
+def write_file(sw1, path, text):
+    sw1("cat > {} << 'EOF'\n{}EOF".format(path, text), shell='bash')
+
+
+def read_attr(sw1, attr):
+    # A write to the fake tree does not truncate the file, as a sysfs
+    # attribute needs no truncation; the value is on the first line.
+    return sw1('head -n1 {}/loc/{}'.format(SYSFS_DIR, attr),
+               shell='bash').strip()
+
+
+def set_led_state(sw1, state):
+    sw1('ovs-vsctl set led {} state={}'.format(LED, state), shell='bash')
+    sleep(1)
+
+
+def restart_ledd(sw1):
+    sw1('systemctl restart ops-ledd', shell='bash')
+    for _ in range(30):
+        sleep(1)
+        out = sw1('ovs-appctl -t ops-ledd ops-ledd/startup', shell='bash')
+        if 'Time to first LED: -' not in out and '(loading)' not in out:
+            return out
+    assert False, 'ops-ledd did not come back up'
+
+
+def test_ledd_ct_sysfs(topology, step):
+    sw1 = topology.get('sw1')
+
+    step('Create a fake LED class device in a tmpfs')
+    sw1('mkdir -p {0} && mount -t tmpfs none {0} && mkdir {0}/loc'
+        .format(SYSFS_DIR), shell='bash')
+    sw1('cd {}/loc && touch brightness trigger delay_on delay_off'
+        .format(SYSFS_DIR), shell='bash')
+
+    step('Add a subsystem with an LED driven through sysfs')
+    sw1('mkdir -p {}'.format(HW_DESC_DIR), shell='bash')
+    write_file(sw1, HW_DESC_DIR + '/manifest.yaml', MANIFEST_YAML)
+    write_file(sw1, HW_DESC_DIR + '/devices.yaml', DEVICES_YAML)
+    write_file(sw1, HW_DESC_DIR + '/led.yaml', LED_YAML)
+    sw1('ovsdb-client transact \'["OpenSwitch", {{"op": "insert", '
+        '"table": "Subsystem", "row": {{"name": "{}", '
+        '"hw_desc_dir": "{}"}}}}]\''.format(SUBSYSTEM, HW_DESC_DIR),
+        shell='bash')
+    sleep(3)
+    assert read_attr(sw1, 'brightness') == '0'
+
+    step('Turn the LED on')
+    set_led_state(sw1, 'on')
+    assert read_attr(sw1, 'trigger') == 'none'
+    assert read_attr(sw1, 'brightness') == '255'
+
+    step('Flash the LED with the kernel timer trigger')
+    set_led_state(sw1, 'flashing')
+    assert read_attr(sw1, 'trigger') == 'timer'
+    assert read_attr(sw1, 'delay_on') == '500'
+    assert read_attr(sw1, 'delay_off') == '500'
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/dump', shell='bash')
+    assert 'LED class device: {}/loc'.format(SYSFS_DIR) in out
+
+    # The kernel shows the trigger in effect in brackets; a plain file
+    # does not, so put it the way the kernel would before restarting.
+    step('Restart ops-ledd with the LED flashing, and check it is left as is')
+    sw1('echo "none [timer]" > {}/loc/trigger'.format(SYSFS_DIR),
+        shell='bash')
+    out = restart_ledd(sw1)
+    assert 'LEDs restored from db: 0' not in out
+    out = sw1('ovs-appctl -t ops-ledd ops-ledd/dump', shell='bash')
+    assert 'LED class writes: 0 (1 LED writes avoided)' in out
+    assert read_attr(sw1, 'trigger') == 'none [timer]'
+
+    step('Turn the LED off')
+    set_led_state(sw1, 'off')
+    assert read_attr(sw1, 'trigger') == 'none'
+    assert read_attr(sw1, 'brightness') == '0'
+    out = sw1('ovs-vsctl get led {} status'.format(LED), shell='bash')
+    assert 'ok' in out
+
+    step('Remove the subsystem and the fake tree')
+    sw1('ovsdb-client transact \'["OpenSwitch", {{"op": "delete", '
+        '"table": "Subsystem", "where": [["name", "==", "{}"]]}}]\''
+        .format(SUBSYSTEM), shell='bash')
+    sleep(1)
+    sw1('umount {0}; rm -rf {0} {1}'.format(SYSFS_DIR, HW_DESC_DIR),
+        shell='bash')
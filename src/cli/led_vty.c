@@ -23,13 +23,20 @@
  * Purpose:  To add system LED CLI configuration and display commands.
  */
 
+#include <ctype.h>
+#include <fnmatch.h>
+#include <stdlib.h>
 #include "vtysh/command.h"
 #include "vtysh/vtysh.h"
 #include "vtysh/vtysh_user.h"
 #include "led_vty.h"
+#include "ledd_row_index.h"
 #include "vswitch-idl.h"
 #include "ovsdb-idl.h"
 #include "smap.h"
+#include "shash.h"
+#include "util.h"
+#include "dynamic-string.h"
 #include "memory.h"
 #include "openvswitch/vlog.h"
 #include "openswitch-idl.h"
@@ -47,6 +54,18 @@ const char *led_state_strings[] = {
     OVSREC_LED_STATE_ON                 /*!< LED state "on" */
 };
 
+#define LED_RANGE_MAX 4096     /* Most LEDs a range can name */
+
+/* LED rows by id, for the commands that look up many LEDs (ranges and
+ * patterns), rebuilt by them when the idl contents have changed. vtysh
+ * shares its idl with every plugin and never clears tracked changes, so
+ * the index is not kept up to date from change tracking as it is in
+ * ops-ledd. A single LED is looked up in the index only while it is
+ * current, and by a scan otherwise, which costs less than a rebuild. */
+static struct ledd_row_index led_rows = {
+    SHASH_INITIALIZER(&led_rows.ids), 0, false
+};
+
 /*
  * Function    : lookup_led
  * Resposibility  : Lookup for led using name
@@ -57,48 +76,374 @@ const char *led_state_strings[] = {
 static const struct ovsrec_led *
 lookup_led (const char *name)
 {
-    const static struct ovsrec_led *led;
+    const struct ovsrec_led *pOvsLed;
+
+    if (led_rows.valid && led_rows.seqno == ovsdb_idl_get_seqno(idl)) {
+        return (ledd_row_index_find(&led_rows, idl, name));
+    }
+
+    OVSREC_LED_FOR_EACH (pOvsLed, idl) {
+        if (strcmp(pOvsLed->id, name) == 0) {
+            return pOvsLed;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Function    : led_parse_range
+ * Resposibility  : Split a range of LED names, such as base-port-1-48,
+ *                  into its prefix and its first and last numbers
+ * Return  : true if name is a range
+ */
+static bool
+led_parse_range (const char *name, size_t *prefix_len, long *first,
+                 long *last)
+{
+    const char *dash = strrchr(name, '-');
+    const char *start;
+    char *end;
+
+    if (dash == NULL || dash == name || !isdigit((unsigned char)dash[1])) {
+        return false;
+    }
+    *last = strtol(dash + 1, &end, 10);
+    if (*end != '\0') {
+        return false;
+    }
+
+    start = dash;
+    while (start > name && isdigit((unsigned char)start[-1])) {
+        start--;
+    }
+    if (start == dash) {
+        return false;
+    }
+    *first = strtol(start, NULL, 10);
+    *prefix_len = start - name;
+
+    return (*first <= *last && *last - *first < LED_RANGE_MAX);
+}
+
+/*
+ * Function    : cli_system_find_leds
+ * Resposibility  : Collect the LEDs named by an LED name, a range of
+ *                  names (base-port-1-48) or a pattern (base-port-*, *)
+ * Parameters
+ *  sLedName: Pointer to led name, range or pattern string
+ *  targets: shash the LED rows are added to, by id
+ * Return      : number of LEDs added
+ */
+static size_t
+cli_system_find_leds (const char *sLedName, struct shash *targets)
+{
+    const struct ovsrec_led *pOvsLed;
+    struct shash_node *node, *next;
+    size_t prefix_len;
+    long first, last, i;
+    size_t n = shash_count(targets);
+
+    pOvsLed = lookup_led(sLedName);
+    if (pOvsLed) {
+        shash_add_once(targets, pOvsLed->id, pOvsLed);
+    } else if (led_parse_range(sLedName, &prefix_len, &first, &last)) {
+        ledd_row_index_refresh(&led_rows, idl);
+        for (i = first; i <= last; i++) {
+            char *id = xasprintf("%.*s%ld", (int)prefix_len, sLedName, i);
+
+            pOvsLed = ledd_row_index_find(&led_rows, idl, id);
+            if (pOvsLed) {
+                shash_add_once(targets, pOvsLed->id, pOvsLed);
+            } else {
+                vty_out(vty,"Cannot find LED %s%s",id,VTY_NEWLINE);
+            }
+            free(id);
+        }
+    } else if (strpbrk(sLedName, "*?[")) {
+        ledd_row_index_refresh(&led_rows, idl);
+        SHASH_FOR_EACH_SAFE (node, next, &led_rows.ids) {
+            if (fnmatch(sLedName, node->name, 0) == 0) {
+                pOvsLed = ledd_row_index_find(&led_rows, idl, node->name);
+                if (pOvsLed) {
+                    shash_add_once(targets, pOvsLed->id, pOvsLed);
+                }
+            }
+        }
+    }
+
+    return (shash_count(targets) - n);
+}
+
+/*
+ * Function    : cli_system_find_subsystem_leds
+ * Resposibility  : Collect the LEDs of a subsystem
+ * Parameters
+ *  sSubsysName: Pointer to subsystem name string
+ *  targets: shash the LED rows are added to, by id
+ * Return      : number of LEDs added
+ */
+static size_t
+cli_system_find_subsystem_leds (const char *sSubsysName,
+                                struct shash *targets)
+{
+    const struct ovsrec_subsystem *pSys;
+    size_t n = shash_count(targets);
+    size_t i;
+
+    OVSREC_SUBSYSTEM_FOR_EACH (pSys, idl) {
+        if (strcmp(pSys->name, sSubsysName) == 0) {
+            for (i = 0; i < pSys->n_leds; i++) {
+                shash_add_once(targets, pSys->leds[i]->id, pSys->leds[i]);
+            }
+        }
+    }
+
+    return (shash_count(targets) - n);
+}
+
+/*
+ * Function    : cli_system_set_leds
+ * Resposibility  : Set the state of a set of LEDs, in one transaction
+ * Parameters
+ *  targets: shash of the LED rows, by id
+ *  sLedState: Pointer to led state string
+ * Return      : CMD_SUCCESS, or CMD_OVSDB_FAILURE
+ */
+static int
+cli_system_set_leds (struct shash *targets, const char *sLedState)
+{
+    struct ovsdb_idl_txn* status_txn = NULL;
+    enum ovsdb_idl_txn_status status;
+    struct shash_node *node;
+
+    status_txn = cli_do_config_start();
+    if (status_txn == NULL)
+    {
+        VLOG_ERR("Unable to acquire transaction");
+        cli_do_config_abort(status_txn);
+        return CMD_OVSDB_FAILURE;
+    }
+
+    SHASH_FOR_EACH (node, targets) {
+        const struct ovsrec_led *pOvsLed = node->data;
 
-    OVSREC_LED_FOR_EACH (led, idl) {
-        if (strcmp(led->id, name) == 0) {
-            return((struct ovsrec_led *)led);
+        if (strcmp(pOvsLed->state, sLedState) != 0) {
+            ovsrec_led_set_state (pOvsLed, sLedState);
         }
     }
 
-    return (NULL);
+    status = cli_do_config_finish (status_txn);
+    if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
+    {
+        return CMD_SUCCESS;
+    }
+
+    VLOG_ERR(OVSDB_TXN_COMMIT_ERROR);
+    return CMD_OVSDB_FAILURE;
+}
+
+/* qsort() comparison of LED rows by id */
+static int
+led_compare_id (const void *a_, const void *b_)
+{
+    const struct ovsrec_led *const *a = a_;
+    const struct ovsrec_led *const *b = b_;
+
+    return strcmp((*a)->id, (*b)->id);
+}
+
+/* qsort() comparison of subsystem rows by name */
+static int
+subsystem_compare_name (const void *a_, const void *b_)
+{
+    const struct ovsrec_subsystem *const *a = a_;
+    const struct ovsrec_subsystem *const *b = b_;
+
+    return strcmp((*a)->name, (*b)->name);
+}
+
+/* True if an LED row passes the state and status filters (NULL for any) */
+static bool
+led_matches (const struct ovsrec_led *pLed, const char *sState,
+             const char *sStatus)
+{
+    return ((sState == NULL || (pLed->state && !strcmp(pLed->state, sState)))
+            && (sStatus == NULL
+                || (pLed->status && !strcmp(pLed->status, sStatus))));
 }
 
 /*
  * Function        : cli_system_get_led
- * Resposibility      : Get system led information from idl
+ * Resposibility      : Get system led information from idl, sorted by name
+ * Parameters
+ *  sSubsysName: Pointer to subsystem name string, NULL for all LEDs
+ *  sState: Pointer to led state string, NULL for any state
+ *  sStatus: Pointer to led status string, NULL for any status
+ *  page: Page of the matches to show, from 1, 0 for all of them
+ *  lines: LEDs per page
  * Return      : 0 on success 1 otherwise
  */
 
 int
-cli_system_get_led ()
+cli_system_get_led (const char *sSubsysName, const char *sState,
+                    const char *sStatus, unsigned int page,
+                    unsigned int lines)
 {
-    const struct ovsrec_led* pLed = NULL;
-    const struct ovsrec_subsystem* pSys = NULL;
+    const struct ovsrec_led **leds;
+    const struct ovsrec_led *pLed;
+    const struct ovsrec_subsystem *pSys;
+    struct ds out = DS_EMPTY_INITIALIZER;
+    size_t n_leds = 0, allocated = 0;
+    size_t i, first = 0, last;
+    size_t n_pages;
+    int width = 15;
+
+    /* One pass over the LEDs (of the subsystem) to collect the matches. */
+    leds = NULL;
+    if (sSubsysName) {
+        OVSREC_SUBSYSTEM_FOR_EACH (pSys, idl) {
+            if (strcmp(pSys->name, sSubsysName) == 0) {
+                for (i = 0; i < pSys->n_leds; i++) {
+                    if (led_matches(pSys->leds[i], sState, sStatus)) {
+                        if (n_leds >= allocated) {
+                            leds = x2nrealloc(leds, &allocated, sizeof *leds);
+                        }
+                        leds[n_leds++] = pSys->leds[i];
+                    }
+                }
+            }
+        }
+    } else {
+        OVSREC_LED_FOR_EACH (pLed, idl) {
+            if (led_matches(pLed, sState, sStatus)) {
+                if (n_leds >= allocated) {
+                    leds = x2nrealloc(leds, &allocated, sizeof *leds);
+                }
+                leds[n_leds++] = pLed;
+            }
+        }
+    }
 
-    pSys = ovsrec_subsystem_first (idl);
+    if (n_leds > 1) {
+        qsort(leds, n_leds, sizeof *leds, led_compare_id);
+    }
 
-    vty_out(vty,"%-15s%-10s%-10s%s","Name","State","Status",VTY_NEWLINE);
-	vty_out(vty,"%s%s","-----------------------------------",VTY_NEWLINE);
+    /* Only the LEDs of the page are formatted. */
+    last = n_leds;
+    n_pages = (n_leds + lines - 1) / lines;
+    if (page > 0) {
+        first = MIN(n_leds, (size_t)(page - 1) * lines);
+        last = MIN(n_leds, first + lines);
+    }
+    for (i = first; i < last; i++) {
+        width = MAX(width, (int)strlen(leds[i]->id) + 1);
+    }
 
-    if (pSys->n_leds)
-    {
-        OVSREC_LED_FOR_EACH (pLed,idl)
-        {
-            if (pLed)
-            {
-                vty_out(vty,"%-15s",pLed->id);
-                vty_out(vty,"%-10s",pLed->state);
-                vty_out(vty,"%-10s",pLed->status);
+    ds_put_format(&out, "%-*s%-10s%-10s%s", width, "Name", "State", "Status",
+                  VTY_NEWLINE);
+    ds_put_char_multiple(&out, '-', width + 20);
+    ds_put_cstr(&out, VTY_NEWLINE);
+    for (i = first; i < last; i++) {
+        ds_put_format(&out, "%-*s%-10s%-10s%s", width, leds[i]->id,
+                      leds[i]->state ? leds[i]->state : "",
+                      leds[i]->status ? leds[i]->status : "", VTY_NEWLINE);
+    }
+    if (page > 0) {
+        ds_put_format(&out, "Page %u of %"PRIuSIZE" (%"PRIuSIZE" LEDs)%s",
+                      page, n_pages, n_leds, VTY_NEWLINE);
+    }
+
+    vty_out(vty, "%s", ds_cstr(&out));
+    ds_destroy(&out);
+    free(leds);
+
+    return CMD_SUCCESS;
+}
+
+/*
+ * Function        : cli_system_get_led_summary
+ * Resposibility      : Show the number of LEDs in each state and status, by
+ *                      subsystem
+ * Return      : 0 on success 1 otherwise
+ */
+
+int
+cli_system_get_led_summary (void)
+{
+    static const char *states[] = {
+        OVSREC_LED_STATE_ON, OVSREC_LED_STATE_OFF, OVSREC_LED_STATE_FLASHING
+    };
+    static const char *statuses[] = {
+        OVSREC_LED_STATUS_OK, OVSREC_LED_STATUS_FAULT,
+        OVSREC_LED_STATUS_UNINITIALIZED
+    };
+    const struct ovsrec_subsystem **subsystems = NULL;
+    const struct ovsrec_subsystem *pSys;
+    struct ds out = DS_EMPTY_INITIALIZER;
+    size_t n_subsystems = 0, allocated = 0;
+    size_t total[ARRAY_SIZE(states) + ARRAY_SIZE(statuses) + 1];
+    size_t i, j, k;
+
+    OVSREC_SUBSYSTEM_FOR_EACH (pSys, idl) {
+        if (n_subsystems >= allocated) {
+            subsystems = x2nrealloc(subsystems, &allocated,
+                                    sizeof *subsystems);
+        }
+        subsystems[n_subsystems++] = pSys;
+    }
+    if (n_subsystems > 1) {
+        qsort(subsystems, n_subsystems, sizeof *subsystems,
+              subsystem_compare_name);
+    }
+
+    ds_put_format(&out, "%-15s%8s%8s%8s%8s%8s%8s%8s%8s%s", "Subsystem",
+                  "LEDs", "on", "off", "flashing", "ok", "fault", "uninit",
+                  "", VTY_NEWLINE);
+    ds_put_char_multiple(&out, '-', 71);
+    ds_put_cstr(&out, VTY_NEWLINE);
+
+    memset(total, 0, sizeof total);
+    for (i = 0; i < n_subsystems; i++) {
+        size_t counts[ARRAY_SIZE(total)];
+
+        memset(counts, 0, sizeof counts);
+        pSys = subsystems[i];
+        for (j = 0; j < pSys->n_leds; j++) {
+            const struct ovsrec_led *pLed = pSys->leds[j];
+
+            counts[0]++;
+            for (k = 0; k < ARRAY_SIZE(states); k++) {
+                if (pLed->state && !strcmp(pLed->state, states[k])) {
+                    counts[1 + k]++;
+                }
             }
-            vty_out(vty,"%s",VTY_NEWLINE);
+            for (k = 0; k < ARRAY_SIZE(statuses); k++) {
+                if (pLed->status && !strcmp(pLed->status, statuses[k])) {
+                    counts[1 + ARRAY_SIZE(states) + k]++;
+                }
+            }
+        }
+
+        ds_put_format(&out, "%-15s", pSys->name);
+        for (k = 0; k < ARRAY_SIZE(counts); k++) {
+            ds_put_format(&out, "%8"PRIuSIZE, counts[k]);
+            total[k] += counts[k];
         }
+        ds_put_cstr(&out, VTY_NEWLINE);
     }
 
+    if (n_subsystems > 1) {
+        ds_put_format(&out, "%-15s", "Total");
+        for (k = 0; k < ARRAY_SIZE(total); k++) {
+            ds_put_format(&out, "%8"PRIuSIZE, total[k]);
+        }
+        ds_put_cstr(&out, VTY_NEWLINE);
+    }
+
+    vty_out(vty, "%s", ds_cstr(&out));
+    ds_destroy(&out);
+    free(subsystems);
+
     return CMD_SUCCESS;
 }
 
@@ -106,7 +451,7 @@ cli_system_get_led ()
  * Function        : cli_system_set_led
  * Resposibility      : Set system led state
  * Parameters
- *  sLedName: Pointer to led name string
+ *  sLedName: Pointer to led name, range or pattern string
  *  sLedState: Pointer to led state string
  * Return      : 0 on success 1 otherwise
  */
@@ -114,91 +459,63 @@ cli_system_get_led ()
 int
 cli_system_set_led (char* sLedName,char* sLedState)
 {
-    const struct ovsrec_led* pOvsLed = NULL;
-    struct ovsdb_idl_txn* status_txn = NULL;
-    enum ovsdb_idl_txn_status status;
-    pOvsLed = lookup_led (sLedName);
+    struct shash targets = SHASH_INITIALIZER(&targets);
+    int rc = CMD_SUCCESS;
 
-    if (pOvsLed)
+    if (cli_system_find_leds(sLedName, &targets))
     {
-        status_txn = cli_do_config_start();
-        if (status_txn != NULL)
-        {
-            ovsrec_led_set_state (pOvsLed, sLedState);
-            status = cli_do_config_finish (status_txn);
-            if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
-            {
-                return CMD_SUCCESS;
-            }
-            else
-            {
-                VLOG_ERR(OVSDB_TXN_COMMIT_ERROR);
-                return CMD_OVSDB_FAILURE;
-            }
-        }
-        else
-        {
-            VLOG_ERR("Unable to acquire transaction");
-            cli_do_config_abort(status_txn);
-            return CMD_OVSDB_FAILURE;
-        }
-
+        rc = cli_system_set_leds(&targets, sLedState);
     }
     else
     {
         vty_out(vty,"Cannot find LED%s",VTY_NEWLINE);
     }
-    return CMD_SUCCESS;
+
+    shash_destroy(&targets);
+    return rc;
 }
 
 /*
  * Func        : cli_system_no_set_led
  * Resposibility      : Set system led state to default
  * Parameters
- *      sLedName: Pointer to led name string
+ *      sLedName: Pointer to led name, range or pattern string
  * Return      : 0 on success 1 otherwise
  */
 
 int
 cli_system_no_set_led (char* sLedName)
 {
-    const struct ovsrec_led* pOvsLed = NULL;
-    struct ovsdb_idl_txn* status_txn = NULL;
-    enum ovsdb_idl_txn_status status;
-    pOvsLed = lookup_led(sLedName);
+    return cli_system_set_led(sLedName, OVSREC_LED_STATE_OFF);
+}
 
-    if (pOvsLed)
-    {
-        status_txn = cli_do_config_start();
-        if (status_txn != NULL)
-        {
-            ovsrec_led_set_state (pOvsLed, OVSREC_LED_STATE_OFF);
-            status = cli_do_config_finish(status_txn);
-            if (status == TXN_SUCCESS || status == TXN_UNCHANGED)
-            {
-                return CMD_SUCCESS;
-            }
-            else
-            {
-                VLOG_ERR(OVSDB_TXN_COMMIT_ERROR);
-                return CMD_OVSDB_FAILURE;
-            }
-        }
-        else
-        {
-            VLOG_ERR("Unable to acquire transaction");
-            cli_do_config_abort(status_txn);
-            return CMD_OVSDB_FAILURE;
-        }
+/*
+ * Function        : cli_system_set_subsystem_leds
+ * Resposibility      : Set the state of all the LEDs of a subsystem
+ * Parameters
+ *  sSubsysName: Pointer to subsystem name string
+ *  sLedState: Pointer to led state string
+ * Return      : 0 on success 1 otherwise
+ */
 
+int
+cli_system_set_subsystem_leds (char* sSubsysName,char* sLedState)
+{
+    struct shash targets = SHASH_INITIALIZER(&targets);
+    int rc = CMD_SUCCESS;
+
+    if (cli_system_find_subsystem_leds(sSubsysName, &targets))
+    {
+        rc = cli_system_set_leds(&targets, sLedState);
     }
     else
     {
-        vty_out(vty,"Cannot find LED%s",VTY_NEWLINE);
+        vty_out(vty,"Cannot find LEDs of subsystem %s%s",sSubsysName,
+                VTY_NEWLINE);
     }
 
-    return CMD_SUCCESS;
-
+    shash_destroy(&targets);
+    return rc;
 }
 
 
@@ -212,14 +529,167 @@ DEFUN (cli_platform_show_led,
         SYS_STR
         LED_STR)
 {
-    return cli_system_get_led();
+    const char *sSubsysName = NULL;
+    const char *sState = NULL;
+    const char *sStatus = NULL;
+    const char *sPage = NULL;
+    const char *sLines = NULL;
+    unsigned int page = 0;
+    unsigned int lines = LED_PAGE_LINES;
+    int i;
+
+    /* Filters and the page come as keyword and value pairs, in any
+       order. */
+    for (i = 0; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "subsystem") == 0)
+        {
+            sSubsysName = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "state") == 0)
+        {
+            sState = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "status") == 0)
+        {
+            sStatus = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "page") == 0)
+        {
+            sPage = argv[i + 1];
+        }
+        else
+        {
+            sLines = argv[i + 1];
+        }
+    }
+
+    if (sState && strcmp(sState, OVSREC_LED_STATE_ON)
+        && strcmp(sState, OVSREC_LED_STATE_OFF)
+        && strcmp(sState, OVSREC_LED_STATE_FLASHING))
+    {
+        vty_out(vty,"Unknown LED state %s%s",sState,VTY_NEWLINE);
+        return CMD_WARNING;
+    }
+    if (sStatus && strcmp(sStatus, OVSREC_LED_STATUS_OK)
+        && strcmp(sStatus, OVSREC_LED_STATUS_FAULT)
+        && strcmp(sStatus, OVSREC_LED_STATUS_UNINITIALIZED))
+    {
+        vty_out(vty,"Unknown LED status %s%s",sStatus,VTY_NEWLINE);
+        return CMD_WARNING;
+    }
+    if (sPage && !str_to_uint(sPage, 10, &page))
+    {
+        page = 0;
+    }
+    if (sPage && (page < 1 || page > LED_PAGE_MAX))
+    {
+        vty_out(vty,"Invalid page %s%s",sPage,VTY_NEWLINE);
+        return CMD_WARNING;
+    }
+    if (sLines && (!str_to_uint(sLines, 10, &lines)
+                   || lines < 1 || lines > LED_PAGE_MAX))
+    {
+        vty_out(vty,"Invalid number of lines %s%s",sLines,VTY_NEWLINE);
+        return CMD_WARNING;
+    }
+
+    /* Lines alone ask for the first page. */
+    if (sLines && !sPage)
+    {
+        page = 1;
+    }
+
+    return cli_system_get_led(sSubsysName, sState, sStatus, page, lines);
+}
+
+#define LED_FILTER_STR \
+        "Show the LEDs of a subsystem\n" \
+        "Show the LEDs in a state\n" \
+        "Show the LEDs with a status\n" \
+        "Show a page of the LEDs\n" \
+        "Number of LEDs per page (Default: 100)\n" \
+        "Subsystem name, LED state (on|off|flashing), LED status " \
+        "(ok|fault|uninitialized), page number or number of LEDs per page\n"
+
+#define LED_FILTER_CMD "(subsystem|state|status|page|lines) WORD"
+
+ALIAS (cli_platform_show_led,
+        cli_platform_show_led_filter1_cmd,
+        "show system led " LED_FILTER_CMD,
+        SHOW_STR
+        SYS_STR
+        LED_STR
+        LED_FILTER_STR)
+
+ALIAS (cli_platform_show_led,
+        cli_platform_show_led_filter2_cmd,
+        "show system led " LED_FILTER_CMD
+        " " LED_FILTER_CMD,
+        SHOW_STR
+        SYS_STR
+        LED_STR
+        LED_FILTER_STR
+        LED_FILTER_STR)
+
+ALIAS (cli_platform_show_led,
+        cli_platform_show_led_filter3_cmd,
+        "show system led " LED_FILTER_CMD
+        " " LED_FILTER_CMD
+        " " LED_FILTER_CMD,
+        SHOW_STR
+        SYS_STR
+        LED_STR
+        LED_FILTER_STR
+        LED_FILTER_STR
+        LED_FILTER_STR)
+
+ALIAS (cli_platform_show_led,
+        cli_platform_show_led_filter4_cmd,
+        "show system led " LED_FILTER_CMD
+        " " LED_FILTER_CMD
+        " " LED_FILTER_CMD
+        " " LED_FILTER_CMD,
+        SHOW_STR
+        SYS_STR
+        LED_STR
+        LED_FILTER_STR
+        LED_FILTER_STR
+        LED_FILTER_STR
+        LED_FILTER_STR)
+
+ALIAS (cli_platform_show_led,
+        cli_platform_show_led_filter5_cmd,
+        "show system led " LED_FILTER_CMD
+        " " LED_FILTER_CMD
+        " " LED_FILTER_CMD
+        " " LED_FILTER_CMD
+        " " LED_FILTER_CMD,
+        SHOW_STR
+        SYS_STR
+        LED_STR
+        LED_FILTER_STR
+        LED_FILTER_STR
+        LED_FILTER_STR
+        LED_FILTER_STR
+        LED_FILTER_STR)
+
+DEFUN (cli_platform_show_led_summary,
+        cli_platform_show_led_summary_cmd,
+        "show system led summary",
+        SHOW_STR
+        SYS_STR
+        LED_STR
+        "Number of LEDs in each state and status, by subsystem\n")
+{
+    return cli_system_get_led_summary();
 }
 
 DEFUN (cli_platform_set_led,
         cli_platform_set_led_cmd,
         "led WORD (on|off|flashing)",
         LED_SET_STR
-        "Name of LED e.g. <base-loc> for locator LED\n"
+        LED_NAME_STR
         "Switch on the LED\n"
         "Switch off the LED(Default)\n"
         "Blink the LED\n")
@@ -234,11 +704,37 @@ DEFUN (no_cli_platform_set_led,
         "no led WORD",
         NO_STR
         LED_SET_STR
-        "Name of LED e.g. <base-loc> for locator LED\n")
+        LED_NAME_STR)
 {
     return cli_system_no_set_led (CONST_CAST(char*,argv[0]));
 }
 
+DEFUN (cli_platform_set_subsystem_led,
+        cli_platform_set_subsystem_led_cmd,
+        "led subsystem WORD (on|off|flashing)",
+        LED_SET_STR
+        "Set the state of all the LEDs of a subsystem\n"
+        "Name of subsystem e.g. <base>\n"
+        "Switch on the LEDs\n"
+        "Switch off the LEDs(Default)\n"
+        "Blink the LEDs\n")
+{
+    return cli_system_set_subsystem_leds (CONST_CAST(char*,argv[0]),
+            CONST_CAST(char*,argv[1]));
+}
+
+DEFUN (no_cli_platform_set_subsystem_led,
+        no_cli_platform_set_subsystem_led_cmd,
+        "no led subsystem WORD",
+        NO_STR
+        LED_SET_STR
+        "Set the state of all the LEDs of a subsystem\n"
+        "Name of subsystem e.g. <base>\n")
+{
+    return cli_system_set_subsystem_leds (CONST_CAST(char*,argv[0]),
+            CONST_CAST(char*,OVSREC_LED_STATE_OFF));
+}
+
 
 /* Initialize ops-ledd cli node.
  */
@@ -257,8 +753,22 @@ void cli_post_init(void)
 
     install_element (ENABLE_NODE, &cli_platform_show_led_cmd);
     install_element (VIEW_NODE, &cli_platform_show_led_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_led_filter1_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_led_filter1_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_led_filter2_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_led_filter2_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_led_filter3_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_led_filter3_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_led_filter4_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_led_filter4_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_led_filter5_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_led_filter5_cmd);
+    install_element (ENABLE_NODE, &cli_platform_show_led_summary_cmd);
+    install_element (VIEW_NODE, &cli_platform_show_led_summary_cmd);
     install_element (CONFIG_NODE, &cli_platform_set_led_cmd);
     install_element (CONFIG_NODE, &no_cli_platform_set_led_cmd);
+    install_element (CONFIG_NODE, &cli_platform_set_subsystem_led_cmd);
+    install_element (CONFIG_NODE, &no_cli_platform_set_subsystem_led_cmd);
 
     retval = install_show_run_config_subcontext(e_vtysh_config_context,
                                       e_vtysh_config_context_led,
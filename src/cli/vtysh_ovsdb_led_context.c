@@ -22,6 +22,8 @@
  *          global config context.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include "vtysh/vty.h"
 #include "vtysh/vector.h"
 #include "vswitch-idl.h"
@@ -29,13 +31,28 @@
 #include "vtysh/vtysh_ovsdb_if.h"
 #include "vtysh/vtysh_ovsdb_config.h"
 #include "vtysh/utils/system_vtysh_utils.h"
+#include "dynamic-string.h"
+#include "util.h"
 #include "vtysh_ovsdb_led_context.h"
 
 #define DEFAULT_LED_STATE OVSREC_LED_STATE_OFF
 
+/* qsort() comparison of LED rows by id */
+static int
+led_compare_id(const void *a_, const void *b_)
+{
+    const struct ovsrec_led *const *a = a_;
+    const struct ovsrec_led *const *b = b_;
+
+    return strcmp((*a)->id, (*b)->id);
+}
+
 /***************************************************************************
 * @function      : vtysh_config_context_led_clientcallback
-* @detail    : client callback routine for LED configuration
+* @detail    : client callback routine for LED configuration. LEDs that are
+*              not in the default state are collected in one pass, sorted by
+*              id so that the output does not depend on IDL hash order, and
+*              printed as a single block
 * @parame[in]
 *   p_private: Void pointer for holding address of vtysh_ovsdb_cbmsg_ptr
 *          structure object
@@ -46,20 +63,45 @@ vtysh_config_context_led_clientcallback(void *p_private)
 {
     vtysh_ovsdb_cbmsg_ptr p_msg = (vtysh_ovsdb_cbmsg *)p_private;
     const struct ovsrec_led *pLedRow = NULL;
+    const struct ovsrec_led **leds = NULL;
+    struct ds out = DS_EMPTY_INITIALIZER;
+    size_t n_leds = 0, allocated = 0;
+    size_t i;
 
     OVSREC_LED_FOR_EACH(pLedRow,p_msg->idl)
     {
-        if(pLedRow)
+        /* Assuming there is no misconfiguration,
+         * state can be on|off|flashing */
+        if(pLedRow->state && strcmp(pLedRow->state,DEFAULT_LED_STATE))
         {
-            /* Assuming there is no misconfiguration,
-             * state can be on|off|flashing */
-            if(0 != strcasecmp(pLedRow->state,DEFAULT_LED_STATE))
+            if(n_leds >= allocated)
             {
-                vtysh_ovsdb_cli_print(p_msg,"%s %s %s", "led",
-                                      pLedRow->id,pLedRow->state);
+                leds = x2nrealloc(leds, &allocated, sizeof *leds);
             }
+            leds[n_leds++] = pLedRow;
+        }
+    }
+
+    if(n_leds == 0)
+    {
+        return e_vtysh_ok;
+    }
+
+    qsort(leds, n_leds, sizeof *leds, led_compare_id);
+    for(i = 0; i < n_leds; i++)
+    {
+        if(i)
+        {
+            ds_put_char(&out, '\n');
         }
+        ds_put_format(&out, "led %s %s", leds[i]->id, leds[i]->state);
     }
 
+    /* vtysh_ovsdb_cli_print() ends the block with the last newline */
+    vtysh_ovsdb_cli_print(p_msg, "%s", ds_cstr(&out));
+
+    ds_destroy(&out);
+    free(leds);
+
     return e_vtysh_ok;
 }
@@ -40,9 +40,11 @@
 #include "dirs.h"
 #include "dummy.h"
 #include "fatal-signal.h"
+#include "hash.h"
 #include "ovsdb-idl.h"
 #include "poll-loop.h"
 #include "simap.h"
+#include "sset.h"
 #include "stream-ssl.h"
 #include "stream.h"
 #include "svec.h"
@@ -57,30 +59,148 @@
 #include "config-yaml.h"
 
 #include "ledd.h"
+#include "ledd_io.h"
+#include "ledd_load.h"
+#include "ledd_pattern.h"
+#include "ledd_prof.h"
+#include "ledd_row_index.h"
+#include "ledd_shard.h"
 #include "eventlog.h"
 
 /* ********* GLOBALS **************** */
 
-bool change_to_commit = false; /*!< True if need to update ovsdb */
-
-/* global yaml config handle */
-YamlConfigHandle yaml_handle;
+/* OVSDB commit pipeline. At most one transaction is in flight at a time.
+   Status writes made while it is in flight are coalesced into the next. */
+static struct ovsdb_idl_txn *commit_txn; /*!< In-flight txn, NULL if none */
+static struct ovs_list dirty_leds = OVS_LIST_INITIALIZER(&dirty_leds);
+                                /*!< LEDs with a status still to be written */
+static struct ovs_list commit_leds = OVS_LIST_INITIALIZER(&commit_leds);
+                                /*!< LEDs with a status in commit_txn */
+static struct ovs_list rowless_leds = OVS_LIST_INITIALIZER(&rowless_leds);
+                                /*!< LEDs with a status to write, whose row
+                                     is not known yet */
+static bool cur_hw_inflight = false; /*!< True if cur_hw is in commit_txn */
+static bool commit_retry_wait = false; /*!< True if waiting to retry */
+static unsigned int commit_retry_seqno; /*!< IDL seqno at TRY_AGAIN */
+static long long int commit_retry_time; /*!< No retry before this (ms) */
+static int commit_backoff;      /*!< Wait after the next failure (ms), 0
+                                     for LEDD_TXN_BACKOFF_MIN_MS */
+
+/* startup timing: when ledd started, and when the first subsystem had
+   its LEDs set up (monotonic, in us) */
+static long long int start_time;
+static long long int first_led_time;
+
+/* LED state change latency: when ovsdb_idl_run() last returned, and when
+   the latency histograms were last reset (monotonic, in us) */
+static long long int idl_run_time;
+static long long int stats_reset_time;
+
+static const char *stage_names[LEDD_NUM_STAGES] = {
+    "dispatch", "write", "commit", "total"
+};
+
+/* update coalescing: db changes that come less than the window apart are
+   applied together, once the window passes with no new change, or once
+   the first of them has waited for the cap (in ms) */
+static int coalesce_window = LEDD_COALESCE_WINDOW_MS;
+static int coalesce_max = LEDD_COALESCE_MAX_MS;
+static int db_coalesce_window = -1;     /*!< Largest set in other_config of
+                                             any subsystem, -1 for none */
+static int db_coalesce_max = -1;        /*!< Same, for the latency cap */
+static long long int last_apply_time;   /*!< Last db changes applied */
+static long long int coalesce_start;    /*!< First held change, 0 if none */
+static long long int coalesce_last;     /*!< Last held change */
+static long long int coalesce_deadline; /*!< When held changes are applied */
+static unsigned int coalesce_seqno;     /*!< IDL seqno of the last change */
+
+/* chunked bring-up: new subsystems have their loc LEDs written at once,
+   and their other LEDs written at most bringup_chunk per pass; their LED
+   rows are published at most bringup_chunk per transaction, loc LEDs
+   first. 0 for no limit */
+static int bringup_chunk = LEDD_BRINGUP_CHUNK;
+static bool bringup_more = false;       /*!< LEDs are left to write */
+
+static int load_threads = 0; /*!< Loader threads, 0 for one per core */
+static const char *led_image_dir = LEDD_IMAGE_DIR; /*!< "" for no images */
+
+/* bus transaction counters, shown in ops-ledd/dump */
+static struct {
+    unsigned long long reads;           /*!< Register reads done */
+    unsigned long long writes;          /*!< Register writes done */
+    unsigned long long reads_avoided;   /*!< Reads saved by the shadow */
+    unsigned long long writes_avoided;  /*!< Writes of unchanged values */
+    unsigned long long writes_combined; /*!< LED writes merged in batches */
+    unsigned long long block_writes;    /*!< Multi-register writes done */
+    unsigned long long sysfs_writes;    /*!< LED class attribute writes done */
+    unsigned long long sysfs_avoided;   /*!< LED class writes of unchanged
+                                             values */
+} bus_stats;
+
+/* LEDs set up with the state of an LED row left by an earlier run */
+static unsigned long long warm_leds;
+
+/* write batch: registers to write and LEDs waiting on them, flushed once
+   per pass so that LEDs sharing a register cost a single bus write */
+static struct ovs_list batch_regs = OVS_LIST_INITIALIZER(&batch_regs);
+static struct ovs_list batch_leds = OVS_LIST_INITIALIZER(&batch_leds);
+
+static bool block_writes = true; /*!< Combine consecutive registers */
+static const char *led_io = "i2c"; /*!< LED I/O backend[:options] */
+
+/* software blink: groups of LEDs running the same pattern, keyed by
+   pattern and start time, and the timer wheel that steps them */
+static struct hmap blink_groups = HMAP_INITIALIZER(&blink_groups);
+static struct ledd_wheel blink_wheel;
+
+static void ledd_blink_stop(struct locl_led *led);
+static int ledd_count_ready_shards(void);
 
 /* define a shash (string hash) to hold the subsystems (by name) */
 struct shash subsystem_data;
 
+/* shash of all locl_led structs, keyed by OVSDB led:id, used to map
+   changed LED rows back to the LED that owns them */
+struct shash led_index;
+
+/* OVSDB LED rows by led:id, kept up to date from IDL change tracking */
+static struct ledd_row_index led_rows;
+
 static struct ovsdb_idl *idl;
 
 static unsigned int idl_seqno;
 
 static unixctl_cb_func ledd_unixctl_dump;
+static unixctl_cb_func ledd_unixctl_startup;
+static unixctl_cb_func ledd_unixctl_io_backend;
 
 static bool cur_hw_set = false; /*!< True if have updated cur_hw_set in db */
 
+static bool have_lock = false; /*!< True if we held the lock on last run */
+
+/* hot standby: without the lock, keep the subsystems, LED states and write
+   batch current from the db, but write nothing to the hardware or the db,
+   so that taking the lock over only costs the writes that are needed */
+static bool hot_standby = false;
+static long long int takeover_time = -1; /*!< Last takeover, in us */
+static unsigned int n_takeovers;        /*!< Times the lock was acquired */
+
+/* sharding: the subsystems this process owns, the lock it takes for them,
+   and the shards that must all be ready before cur_hw is set. Each shard
+   reports itself ready by setting cur_hw in a daemon row of its own, named
+   after the shard, and clears it when it exits. */
+static struct ledd_shard shard;         /*!< No spec: every subsystem */
+static char *lock_name = NULL;          /*!< NULL for the default */
+static struct sset all_shards = SSET_INITIALIZER(&all_shards);
+                                        /*!< Every shard, this one too */
+static char *shard_daemon_name;         /*!< Shard daemon row, or NULL */
+static bool shard_ready_inflight = false; /*!< Shard row is in commit_txn */
+static bool shard_ready_set = false;    /*!< Shard row is in the db */
+
 /*  ********* UTILITIES **************** */
 
 YamlLedTypeValue
-ledd_led_type_string_to_enum(char *type_string)
+ledd_led_type_string_to_enum(const char *type_string)
 {
     if (strcmp(type_string, "loc") == 0) {
         return (LED_LOC);
@@ -89,29 +209,10 @@ ledd_led_type_string_to_enum(char *type_string)
     return (LED_UNKNOWN);
 } /* ledd_led_type_string_to_enum() */
 
-YamlLedType *
-ledd_get_led_type(struct locl_subsystem *subsys, char *value)
-{
-    struct shash_node *node;
-    YamlLedType *type;
-
-    SHASH_FOR_EACH(node, &(subsys->subsystem_types)) {
-        type = (YamlLedType *)node->data;
-
-        if (strcmp(type->type,value) == 0) {
-            return (type);
-        }
-    }
-
-    return ((YamlLedType *) NULL);
-
-} /* ledd_get_led_type() */
-
 /************************************************************************//**
  * Function that will remove the internal entry in the locl_subsystem hash
  * for any subsystem that is no longer in OVSDB.
  *
- * @todo OPS_TODO: need to remove subsystem yaml data
  * @todo OPS_TODO: verify that ovsdb has deleted the leds (automatic)
  ***************************************************************************/
 static void
@@ -120,13 +221,17 @@ ledd_remove_unmarked_subsystems(void)
     struct shash_node *node, *next;
     struct shash_node *led_node, *led_next;
     struct shash_node *type_node, *type_next;
+    struct ledd_reg *reg, *reg_next;
+    int idx;
 
-    /* Delete subsystems that no longer exist in the DB */
+    /* Delete subsystems that no longer exist in the DB. Subsystems still
+       loading are deleted once loaded, since the loader owns their name. */
 
     SHASH_FOR_EACH_SAFE(node, next, &subsystem_data) {
         struct locl_subsystem *subsystem = node->data;
 
-        if (subsystem->marked == false) {
+        if (subsystem->marked == false
+            && subsystem->subsys_status != LEDD_SUBSYS_STATUS_LOADING) {
             VLOG_DBG("removing subsystem %s", subsystem->name);
 
             /* delete all leds in the subsystem */
@@ -134,7 +239,11 @@ ledd_remove_unmarked_subsystems(void)
                                 &(subsystem->subsystem_leds)) {
                 struct locl_led *led = (struct locl_led *)led_node->data;
 
-                /* delete the subsystem entry */
+                /* delete the index and subsystem entries */
+                list_remove(&led->status_node);
+                list_remove(&led->write_node);
+                ledd_blink_stop(led);
+                shash_find_and_delete(&led_index, led->name);
                 shash_delete(&subsystem->subsystem_leds, led_node);
 
                 /* free the allocated data */
@@ -142,294 +251,1442 @@ ledd_remove_unmarked_subsystems(void)
                 free(led);
             }
 
-            /* delete all LED types in the subsystem */
-            SHASH_FOR_EACH_SAFE(type_node, type_next,
-                                &(subsystem->subsystem_types)) {
+            /* delete all shadow registers in the subsystem */
+            HMAP_FOR_EACH_SAFE(reg, reg_next, node, &subsystem->led_regs) {
+                list_remove(&reg->batch_node);
+                hmap_remove(&subsystem->led_regs, &reg->node);
+                if (reg->n_inflight > 0) {
+                    /* freed by ledd_complete_job() */
+                    reg->subsystem = NULL;
+                } else {
+                    free(reg);
+                }
+            }
+            hmap_destroy(&subsystem->led_regs);
+
+            /* delete the LED patterns of the subsystem (no LED uses them) */
+            SHASH_FOR_EACH_SAFE(type_node, type_next, &subsystem->patterns) {
+                ledd_pattern_destroy(type_node->data);
+                shash_delete(&subsystem->patterns, type_node);
+            }
+            shash_destroy(&subsystem->patterns);
+            smap_destroy(&subsystem->pattern_config);
+
+            /* bus jobs still in flight hold their own reference */
+            ledd_desc_unref(subsystem->desc);
 
-                /* delete the subsystem entry */
-                shash_delete(&subsystem->subsystem_types, type_node);
+            for (idx = 0; idx < LEDD_NUM_STAGES; idx++) {
+                ledd_hist_reset(&subsystem->latency[idx]);
             }
+
+            /* a subsystem that failed to set up has no write plans */
+            if (subsystem->led_plans != NULL) {
+                for (idx = 0; idx < subsystem->num_leds; idx++) {
+                    ledd_sysfs_close(subsystem->led_plans[idx].sysfs);
+                }
+            }
+            free(subsystem->led_plans);
+            free(subsystem->bringup);
             free(subsystem->name);
             free(subsystem);
 
             shash_delete(&subsystem_data, node);
 
-            /* OPS_TODO: need to remove subsystem yaml data */
             /* OPS_TODO: verify that ovsdb has deleted the leds (automatic) */
         }
     }
 } /* ledd_remove_unmarked_subsystems() */
 
+/* queue the status of the LED to be written in the next transaction */
+static void
+ledd_mark_status_dirty(struct locl_led *led)
+{
+    list_remove(&led->status_node);
+    list_push_back(&dirty_leds, &led->status_node);
+} /* ledd_mark_status_dirty() */
+
 /************************************************************************//**
- * Function that sets the LED to the value specified in ovsdb state variable.
+ * STRUCT of a bus job on one or more consecutive LED control registers.
+ * Writes carry the LEDs whose status depends on them.
+ ***************************************************************************/
+struct ledd_reg_job {
+    struct ledd_io_job io;              /*!< Bus job */
+    struct ovs_list leds;               /*!< LEDs waiting on this write */
+    struct ledd_desc *desc;             /*!< Yaml data, referenced */
+    size_t n_regs;                      /*!< Number of registers */
+    struct ledd_reg *regs[];            /*!< Registers, in address order */
+};
+
+/* value of the register once the write batch is applied */
+static uint32_t
+ledd_reg_next(const struct ledd_reg *reg)
+{
+    return((reg->queued & ~reg->pend_mask) | reg->pend_bits);
+} /* ledd_reg_next() */
+
+/* take the register out of the write batch */
+static void
+ledd_unbatch_reg(struct ledd_reg *reg)
+{
+    list_remove(&reg->batch_node);
+    list_init(&reg->batch_node);
+    reg->dirty = false;
+    reg->pend_mask = 0;
+    reg->pend_bits = 0;
+} /* ledd_unbatch_reg() */
+
+/************************************************************************//**
+ * Function that submits a bus job that reads or writes n_regs registers,
+ *     consecutive on the same device, with a single (block) transaction.
+ *     Registers are little endian. Whole registers are written, without
+ *     the read-modify-write done by i2c_reg_write().
  *
  * Logic:
- *     - Retrieves the LED type
- *     - Retrieves the i2c settings for the LED type
- *     - Retrieves the value to write to the LED to match ovsdb state variable
- *     - Retrieves the i2c device access information
- *     - Reads the current value of the LED register
- *     - Writes the new value of the LED register (bitwise OR)
+ *     - build the job; for a write, with the batched register values
+ *     - hand it to the worker for the bus of the device
+ *     - for a write, take the registers out of the write batch
  *
- * Returns: True on success, else False for any failure
+ * Returns: the job, or NULL if the bus worker is full
  ***************************************************************************/
-bool
-ledd_write_led(struct locl_subsystem *subsys, struct locl_led *led)
+static struct ledd_reg_job *
+ledd_submit_job(enum ledd_io_op op, struct ledd_reg **regs, size_t n_regs)
 {
-    YamlLedTypeSettings *settings;
-    YamlLedType *type;
-    i2c_bit_op *reg_op;
+    struct ledd_reg_job *job;
+    uint32_t byte_count = 0;
     uint32_t value;
-    int rc;
-    YamlLedTypeValue type_value;
-
-    reg_op = led->yaml_led->led_access;
-
-    /* Get the LED type */
-    type = ledd_get_led_type(subsys, led->yaml_led->type);
-    if (type == (YamlLedType *) NULL) {
-        VLOG_DBG("ledd_write: type is null");
-        return (false);
-    }
-
-    settings = &(type->settings);
+    uint32_t idx;
+    size_t i;
 
-    if (settings == NULL) {
-        VLOG_WARN("No settings for subsystem %s, LED %s",
-                subsys->name, led->name);
-        return (false);
+    job = xzalloc(sizeof *job + n_regs * sizeof *job->regs);
+    job->io.op = op;
+    job->desc = regs[0]->subsystem->desc;
+    job->io.handle = job->desc->handle;
+    job->io.yaml_name = job->desc->name;
+    job->io.subsystem = xstrdup(regs[0]->subsystem->name);
+    job->io.yaml_device = regs[0]->yaml_device;
+    job->io.device = regs[0]->device;
+    job->io.reg = regs[0]->reg;
+    list_init(&job->leds);
+    job->n_regs = n_regs;
+
+    for (i = 0; i < n_regs; i++) {
+        job->regs[i] = regs[i];
+        value = ledd_reg_next(regs[i]);
+        for (idx = 0; idx < regs[i]->size; idx++) {
+            job->io.data[byte_count++] = (value >> (8 * idx)) & 0xff;
+        }
     }
+    job->io.byte_count = byte_count;
 
-    /* Get the value to set the LED to. */
-    if (type->type == (char *) NULL) {
-        VLOG_WARN("led type is NULL for subsystem %s, LED %s",
-                subsys->name, led->name);
-        return (false);
+    if (!ledd_io_submit(&job->io)) {
+        free(job->io.subsystem);
+        free(job);
+        return(NULL);
     }
+    ledd_desc_ref(job->desc);
 
-    /* Get the settings for this type */
-    type_value = ledd_led_type_string_to_enum(type->type);
-    switch (type_value) {
-        case LED_LOC:
-            switch (led->state) {
-                case LED_STATE_FLASHING:
-                    value = settings->flashing;
-                    break;
-                case LED_STATE_OFF:
-                    value = settings->off;
-                    break;
-                case LED_STATE_ON:
-                    value = settings->on;
-                    break;
-                default:
-                    VLOG_WARN("Invalid state %d for subsystem %s, LED %s",
-                            led->state, subsys->name, led->name);
-                    return(false);
-            }
-            break;
-        case LED_UNKNOWN:
-            /* Fall through */
-        default:
-            VLOG_WARN("Unknown or no type %d for subsystem %s, LED %s",
-                            type_value, subsys->name, led->name);
-            return(false);
+    for (i = 0; i < n_regs; i++) {
+        regs[i]->n_inflight++;
+        if (op == LEDD_IO_READ) {
+            regs[i]->reading = true;
+        } else {
+            regs[i]->queued = ledd_reg_next(regs[i]);
+            regs[i]->last_job = job;
+            ledd_unbatch_reg(regs[i]);
+        }
     }
 
-    rc = i2c_reg_write(yaml_handle, subsys->name, reg_op, value);
-
-    if (rc != 0) {
-        VLOG_WARN("subsystem %s: unable to set LED control register (%d)",
-                    subsys->name, rc);
-        return(false);
+    if (op == LEDD_IO_READ) {
+        bus_stats.reads++;
+    } else {
+        bus_stats.writes++;
+        if (n_regs > 1) {
+            bus_stats.block_writes++;
+        }
     }
 
-    return(true);
-} /* ledd_write_led() */
+    return(job);
+} /* ledd_submit_job() */
 
-/* initialize the subsystem data */
+/* record the latency of a stage of an LED state change, if it is timed */
 static void
-init_subsystems(void)
+ledd_record_latency(struct locl_led *led, enum ledd_stage stage,
+                    long long int from, long long int to)
 {
-    shash_init(&subsystem_data);
-} /* init_subsystems() */
+    if (from != 0 && to >= from) {
+        ledd_hist_record(&led->subsystem->latency[stage], to - from);
+    }
+} /* ledd_record_latency() */
 
-enum ovsrec_led_status_e
-ledd_status_to_enum(char *status)
+/* end the timing of an LED state change, once its status is in the db */
+static void
+ledd_record_committed(struct locl_led *led)
 {
-    size_t i;
+    if (led->stamps[LEDD_STAMP_WRITTEN] != 0) {
+        long long int now = time_usec();
 
-    if (status == NULL) {
-        return(LED_STATUS_UNINITIALIZED);
+        ledd_record_latency(led, LEDD_STAGE_COMMIT,
+                            led->stamps[LEDD_STAMP_WRITTEN], now);
+        ledd_record_latency(led, LEDD_STAGE_TOTAL,
+                            led->stamps[LEDD_STAMP_CHANGED], now);
     }
+    memset(led->stamps, 0, sizeof led->stamps);
+} /* ledd_record_committed() */
 
-    for (i = 0; i < sizeof(led_status_strings)/sizeof(const char *); i++) {
-        if (strcmp(led_status_strings[i], status) == 0) {
-            return( (enum ovsrec_led_status_e)i );
-        }
+/* set the status of an LED from the result of its write */
+static void
+ledd_set_write_status(struct locl_led *led, bool ok)
+{
+    if (led->stamps[LEDD_STAMP_WRITE] != 0) {
+        led->stamps[LEDD_STAMP_WRITTEN] = time_usec();
+        ledd_record_latency(led, LEDD_STAGE_WRITE,
+                            led->stamps[LEDD_STAMP_WRITE],
+                            led->stamps[LEDD_STAMP_WRITTEN]);
+        led->stamps[LEDD_STAMP_WRITE] = 0;
     }
 
-    return(LED_STATUS_UNINITIALIZED);
-
-} /* ledd_status_to_enum() */
+    if (ok) {
+        VLOG_DBG("ledd_write successful, %s", led->name);
+        led->status = LED_STATUS_OK;
+    } else {
+        VLOG_WARN("ledd_write failed, %s", led->name);
+        led->status = LED_STATUS_FAULT;
+    }
+    ledd_mark_status_dirty(led);
+} /* ledd_set_write_status() */
 
-enum ovsrec_led_state_e
-ledd_state_to_enum(char *state)
+/************************************************************************//**
+ * Function that applies the result of a completed bus job to the shadow
+ *     registers and to the LEDs that were waiting on it.
+ *
+ * Logic:
+ *     - for each register in the job
+ *         - free it, if its subsystem was removed while the job was in
+ *           flight and this was its last job
+ *         - after a read, seed the shadow (unless a write completed in
+ *           the meantime, which wrote the whole register)
+ *         - after a write, update the shadow, or else mark it unknown
+ *     - set the status of each LED waiting on the job
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+ledd_complete_job(struct ledd_reg_job *job)
 {
+    const struct ledd_io_job *io = &job->io;
+    struct locl_led *led;
+    uint32_t byte_count = 0;
+    uint32_t value;
+    uint32_t idx;
     size_t i;
 
-    if (state == NULL) {
-        return(LED_STATE_OFF);
+    if (io->rc != 0) {
+        VLOG_WARN("subsystem %s: unable to %s LED control register "
+                  "%s 0x%x (%d)", io->subsystem,
+                  io->op == LEDD_IO_READ ? "read" : "set",
+                  io->device, io->reg, io->rc);
     }
 
-    for (i = 0; i < sizeof(led_state_strings)/sizeof(const char *); i++) {
-        if (strcmp(led_state_strings[i], state) == 0) {
-            return( (enum ovsrec_led_state_e)i );
+    for (i = 0; i < job->n_regs; i++) {
+        struct ledd_reg *reg = job->regs[i];
+
+        value = 0;
+        for (idx = 0; idx < reg->size; idx++) {
+            value |= (uint32_t)io->data[byte_count++] << (8 * idx);
         }
-    }
 
-    return(LED_STATE_OFF);
+        reg->n_inflight--;
+        if (reg->subsystem == NULL) {
+            if (reg->n_inflight == 0) {
+                free(reg);
+            }
+            continue;
+        }
 
-} /* ledd_state_to_enum() */
+        if (reg->last_job == job) {
+            reg->last_job = NULL;
+        }
 
-static const char *
-ledd_state_to_string(enum ovsrec_led_state_e state)
-{
-    if ((unsigned int)state <
-                sizeof(led_state_strings)/sizeof(const char *)) {
-        return(led_state_strings[state]);
-    } else {
-        return(led_state_strings[LED_STATE_OFF]);
+        if (io->op == LEDD_IO_READ) {
+            reg->reading = false;
+            reg->read_failed = (io->rc != 0);
+            if (io->rc == 0 && !reg->valid) {
+                reg->value = value;
+                reg->queued = value;
+                reg->valid = true;
+            }
+        } else if (io->rc == 0) {
+            reg->value = value;
+            reg->valid = true;
+        } else {
+            /* The register may or may not have changed: re-read it. */
+            reg->valid = false;
+        }
     }
-} /* ledd_state_to_string() */
 
-static const char *
-ledd_status_to_string(enum ovsrec_led_status_e status)
-{
-    if ((unsigned int)status < sizeof(led_status_strings)/sizeof(const char *)){
-        return(led_status_strings[status]);
-    } else {
-        return(led_status_strings[LED_STATUS_UNINITIALIZED]);
+    LIST_FOR_EACH_POP(led, write_node, &job->leds) {
+        list_init(&led->write_node);
+        ledd_set_write_status(led, io->rc == 0);
     }
-} /* ledd_status_to_string() */
 
+    ledd_desc_unref(job->desc);
+    free(job->io.subsystem);
+    free(job);
+} /* ledd_complete_job() */
+
+/* apply the results of all the bus jobs completed since the last pass */
 static void
-ledd_unixctl_dump(struct unixctl_conn *conn, int argc OVS_UNUSED,
-                          const char *argv[] OVS_UNUSED, void *aux OVS_UNUSED)
+ledd_reap_jobs(void)
 {
-    struct ds ds = DS_EMPTY_INITIALIZER;
-    struct shash_node *snode;
-    struct shash_node *lnode;
-
-    ds_put_cstr(&ds, "Support Dump for Platform LED Daemon (ops-ledd)\n");
+    struct ledd_io_job *io;
 
-    SHASH_FOR_EACH(snode, &subsystem_data) {
-        struct locl_subsystem *subsystem = (struct locl_subsystem *)snode->data;
+    while ((io = ledd_io_poll()) != NULL) {
+        ledd_prof_wakeup(LEDD_WAKEUP_WORKER);
+        ledd_complete_job(CONTAINER_OF(io, struct ledd_reg_job, io));
+    }
+} /* ledd_reap_jobs() */
 
-        ds_put_format(&ds, "\nSubsystem: %s\n", subsystem->name);
+/************************************************************************//**
+ * Function that finds the shadow of the register used by an LED write plan,
+ *     creating it and starting to read it from the hardware if this is the
+ *     first LED in that register.
+ *
+ * Returns: the shadow register, or NULL if its device is unknown
+ ***************************************************************************/
+static struct ledd_reg *
+ledd_get_reg(struct locl_subsystem *subsys, const struct ledd_led_plan *plan)
+{
+    const YamlDevice *yaml_device;
+    struct ledd_reg *reg;
+    uint32_t hash;
+
+    hash = hash_string(plan->device, plan->reg);
+    HMAP_FOR_EACH_WITH_HASH(reg, node, hash, &subsys->led_regs) {
+        if (reg->reg == plan->reg && strcmp(reg->device, plan->device) == 0) {
+            return(reg);
+        }
+    }
 
-        SHASH_FOR_EACH(lnode, &(subsystem->subsystem_leds)) {
-            struct locl_led *led = (struct locl_led *)lnode->data;
+    yaml_device = yaml_find_device(subsys->desc->handle, subsys->desc->name,
+                                   plan->device);
+    if (yaml_device == NULL) {
+        VLOG_WARN("subsystem %s: unknown LED device %s",
+                  subsys->name, plan->device);
+        return(NULL);
+    }
 
-            ds_put_format(&ds, "\tLED name: %s\n", led->name);
-            ds_put_format(&ds, "\tLED type: %s\n", led->yaml_led->type);
-            ds_put_format(&ds, "\tLED state: %s\n",
-                                        ledd_state_to_string(led->state));
-            ds_put_format(&ds, "\tLED status: %s\n",
-                                        ledd_status_to_string(led->status));
-        }
+    reg = xzalloc(sizeof(*reg));
+    reg->subsystem = subsys;
+    reg->device = plan->device;
+    reg->yaml_device = yaml_device;
+    reg->reg = plan->reg;
+    reg->size = plan->size;
+    if (reg->size == 0 || reg->size > sizeof(uint32_t)) {
+        reg->size = 1;
+    }
+    list_init(&reg->batch_node);
+    hmap_insert(&subsys->led_regs, &reg->node, hash);
+
+    /* If the worker is full, the read is retried by ledd_flush_writes().
+       A hot standby leaves the bus alone; the register is read before it
+       is first written, once it has the lock. */
+    if (have_lock) {
+        (void)ledd_submit_job(LEDD_IO_READ, &reg, 1);
     }
 
-    unixctl_command_reply(conn, ds_cstr(&ds));
-    ds_destroy(&ds);
-} /* ledd_unixctl_dump() */
+    return(reg);
+} /* ledd_get_reg() */
 
+/************************************************************************//**
+ * Function that compiles the write plan for an LED: resolves the LED type
+ *     and its settings once, so that writing the LED needs no lookups.
+ *
+ * Logic:
+ *     - Retrieves the LED type
+ *     - Retrieves the settings for the LED type
+ *     - Records the value to write to the LED for each led state
+ *     - Records the i2c register access information, or opens the LED
+ *       class device of an LED driven through sysfs
+ *     - Records whether flashing must be done in software
+ *     - Finds (or creates and starts reading) the shadow of the LED
+ *       register
+ *
+ * Returns: void (plan->valid is False if the LED cannot be written)
+ ***************************************************************************/
 static void
-usage(void)
+ledd_compile_led_plan(struct locl_subsystem *subsys,
+                      const struct ledd_image *image,
+                      const struct ledd_image_led *led,
+                      struct ledd_led_plan *plan)
 {
-    printf("%s: OpenSwitch ledd daemon\n"
-           "usage: %s [OPTIONS] [DATABASE]\n"
-           "where DATABASE is a socket on which ovsdb-server is listening\n"
-           "      (default: \"unix:%s/db.sock\").\n",
-           program_name, program_name, ovs_rundir());
-    stream_usage("DATABASE", true, false, true);
-    daemon_usage();
-    vlog_usage();
-    printf("\nOther options:\n"
-           "  --unixctl=SOCKET        override default control socket name\n"
-           "  -h, --help              display this help message\n"
-           "  -V, --version           display version information\n");
-    exit(EXIT_SUCCESS);
-} /* usage() */
+    const char *name = ledd_image_string(image, led->name);
+    const char *type = ledd_image_string(image, led->type);
+    size_t idx;
 
-static char *
-parse_options(int argc, char *argv[], char **unixctl_pathp)
-{
-    enum {
-        OPT_PEER_CA_CERT = UCHAR_MAX + 1,
-        OPT_UNIXCTL,
-        VLOG_OPTION_ENUMS,
-        OPT_BOOTSTRAP_CA_CERT,
-        OPT_ENABLE_DUMMY,
-        OPT_DISABLE_SYSTEM,
-        DAEMON_OPTION_ENUMS,
-        OPT_DPDK,
-    };
-    static const struct option long_options[] = {
-        {"help",        no_argument, NULL, 'h'},
-        {"version",     no_argument, NULL, 'V'},
-        {"unixctl",     required_argument, NULL, OPT_UNIXCTL},
-        DAEMON_LONG_OPTIONS,
-        VLOG_LONG_OPTIONS,
-        STREAM_SSL_LONG_OPTIONS,
-        {"peer-ca-cert", required_argument, NULL, OPT_PEER_CA_CERT},
-        {"bootstrap-ca-cert", required_argument, NULL, OPT_BOOTSTRAP_CA_CERT},
-        {NULL, 0, NULL, 0},
-    };
-    char *short_options = long_options_to_short_options(long_options);
+    memset(plan, 0, sizeof(*plan));
 
-    for (;;) {
-        int c;
+    /* Get the LED type */
+    if (led->flags & LEDD_IMAGE_LED_NO_TYPE) {
+        VLOG_DBG("subsystem %s, LED %s: type is null",
+                subsys->name, name);
+        return;
+    }
 
-        c = getopt_long(argc, argv, short_options, long_options, NULL);
-        if (c == -1) {
+    /* Get the settings for this type */
+    switch (ledd_led_type_string_to_enum(type)) {
+        case LED_LOC:
+            plan->value[LED_STATE_FLASHING] = led->flashing;
+            plan->value[LED_STATE_OFF] = led->off;
+            plan->value[LED_STATE_ON] = led->on;
             break;
-        }
-
-        switch (c) {
-        case 'h':
-            usage();
+        case LED_UNKNOWN:
+            /* Fall through */
+        default:
+            VLOG_WARN("Unknown or no type %s for subsystem %s, LED %s",
+                            type, subsys->name, name);
+            return;
+    }
 
-        case 'V':
-            ovs_print_version(OFP10_VERSION, OFP10_VERSION);
-            exit(EXIT_SUCCESS);
+    if (led->flags & LEDD_IMAGE_LED_NO_ACCESS) {
+        VLOG_WARN("No LED access information for subsystem %s, LED %s",
+                subsys->name, name);
+        return;
+    }
+    plan->device = ledd_image_string(image, led->device);
 
-        case OPT_UNIXCTL:
-            *unixctl_pathp = optarg;
-            break;
+    /* An LED class device has no register; its type settings are
+       brightness values. */
+    if (ledd_sysfs_is_sysfs(plan->device)) {
+        plan->sysfs = ledd_sysfs_open(plan->device);
+        plan->valid = (plan->sysfs != NULL);
+        return;
+    }
 
-        VLOG_OPTION_HANDLERS
-        DAEMON_OPTION_HANDLERS
-        STREAM_SSL_OPTION_HANDLERS
+    if (led->mask == 0) {
+        VLOG_WARN("No LED access information for subsystem %s, LED %s",
+                subsys->name, name);
+        return;
+    }
+    plan->reg = led->reg;
+    plan->size = led->size;
+    plan->mask = led->mask;
 
-        case OPT_PEER_CA_CERT:
-            stream_ssl_set_peer_ca_cert_file(optarg);
-            break;
+    /* Values are shifted into the LED bits, as i2c_reg_write() does. */
+    for (idx = 0; idx < LEDD_NUM_STATES; idx++) {
+        plan->bits[idx] = (plan->value[idx] << ctz32(plan->mask)) & plan->mask;
+    }
 
-        case OPT_BOOTSTRAP_CA_CERT:
-            stream_ssl_set_ca_cert_file(optarg, true);
-            break;
+    /* If flashing looks the same as on or off, the hardware cannot
+       flash this LED by itself. */
+    plan->soft_blink = plan->bits[LED_STATE_ON] != plan->bits[LED_STATE_OFF]
+        && (plan->bits[LED_STATE_FLASHING] == plan->bits[LED_STATE_ON]
+            || plan->bits[LED_STATE_FLASHING] == plan->bits[LED_STATE_OFF]);
 
-        case '?':
-            exit(EXIT_FAILURE);
+    plan->shadow = ledd_get_reg(subsys, plan);
+    plan->valid = (plan->shadow != NULL);
+} /* ledd_compile_led_plan() */
 
-        default:
-            abort();
+/* merge new values of some bits of a register into the write batch */
+static void
+ledd_stage_reg(struct ledd_reg *reg, uint32_t mask, uint32_t bits)
+{
+    if (reg->dirty) {
+        bus_stats.writes_combined++;
+    } else {
+        if (reg->valid) {
+            bus_stats.reads_avoided++;
         }
+        reg->dirty = true;
+        list_push_back(&batch_regs, &reg->batch_node);
     }
-    free(short_options);
 
-    argc -= optind;
-    argv += optind;
+    reg->pend_mask |= mask;
+    reg->pend_bits = (reg->pend_bits & ~mask) | bits;
+} /* ledd_stage_reg() */
+
+/************************************************************************//**
+ * Function that finds whether the LEDs of a blink group are on at time
+ *     now. Repeating patterns start at time 0 of the monotonic clock, so
+ *     all LEDs running the same pattern are in sync; one-shot patterns
+ *     start when their group was created.
+ *
+ * Returns: True if the LEDs are on; *next is set to the time of the next
+ *          step, or to LLONG_MAX if the pattern is over
+ ***************************************************************************/
+static bool
+ledd_blink_is_on(const struct ledd_blink_group *group, long long int now,
+                 long long int *next)
+{
+    size_t step;
+
+    step = ledd_pattern_step_at(group->pattern, now - group->origin, next);
+    if (*next != LLONG_MAX) {
+        *next += group->origin;
+    }
+
+    return(group->pattern->steps[step].on);
+} /* ledd_blink_is_on() */
+
+/************************************************************************//**
+ * Functions that add an LED to, and remove it from, the blink group for
+ *     its pattern. A group exists only while it has LEDs, so its timer
+ *     only runs while some LED is blinking.
+ *
+ * Returns: ledd_blink_start() returns True if the LED is on right now
+ ***************************************************************************/
+static bool
+ledd_blink_start(struct locl_led *led, const struct ledd_pattern *pattern)
+{
+    struct ledd_blink_group *group;
+    long long int now = time_msec();
+    long long int origin;
+    long long int next;
+    uint32_t hash;
+
+    if (led->blink != NULL && led->blink->pattern == pattern) {
+        return(ledd_blink_is_on(led->blink, now, &next));
+    }
+    ledd_blink_stop(led);
+
+    origin = pattern->once ? now : 0;
+    hash = hash_pointer(pattern, hash_uint64(origin));
+    HMAP_FOR_EACH_WITH_HASH(group, node, hash, &blink_groups) {
+        if (group->pattern == pattern && group->origin == origin) {
+            break;
+        }
+    }
+
+    if (group == NULL) {
+        group = xzalloc(sizeof *group);
+        group->pattern = pattern;
+        group->origin = origin;
+        list_init(&group->leds);
+        list_init(&group->timer.node);
+        hmap_insert(&blink_groups, &group->node, hash);
+
+        (void)ledd_blink_is_on(group, now, &next);
+        if (next != LLONG_MAX) {
+            ledd_wheel_add(&blink_wheel, &group->timer, next);
+        }
+    }
+
+    led->blink = group;
+    list_push_back(&group->leds, &led->blink_node);
+
+    return(ledd_blink_is_on(group, now, &next));
+} /* ledd_blink_start() */
+
+static void
+ledd_blink_stop(struct locl_led *led)
+{
+    struct ledd_blink_group *group = led->blink;
+
+    if (group == NULL) {
+        return;
+    }
+
+    list_remove(&led->blink_node);
+    list_init(&led->blink_node);
+    led->blink = NULL;
+
+    if (list_is_empty(&group->leds)) {
+        ledd_wheel_remove(&blink_wheel, &group->timer);
+        hmap_remove(&blink_groups, &group->node);
+        free(group);
+    }
+} /* ledd_blink_stop() */
+
+/************************************************************************//**
+ * Function that moves every blink group whose timer has expired to the
+ *     next step of its pattern. The new register values go into the write
+ *     batch, so all the LEDs that change in a tick (across groups, when
+ *     their steps line up) cost a single bus write per register, or per
+ *     run of consecutive registers.
+ *
+ * Steps do not change the LED status; a failed write is logged by
+ * ledd_complete_job(), and the next step retries it.
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+ledd_blink_run(void)
+{
+    struct ledd_wheel_timer *timer;
+    long long int now = time_msec();
+
+    while ((timer = ledd_wheel_expired(&blink_wheel, now)) != NULL) {
+        struct ledd_blink_group *group;
+        struct locl_led *led;
+        long long int next;
+        int state;
+
+        ledd_prof_wakeup(LEDD_WAKEUP_TIMER);
+        group = CONTAINER_OF(timer, struct ledd_blink_group, timer);
+        state = ledd_blink_is_on(group, now, &next)
+                ? LED_STATE_ON : LED_STATE_OFF;
+
+        COVERAGE_INC(ledd_blink_tick);
+        LIST_FOR_EACH(led, blink_node, &group->leds) {
+            if (led->plan->sysfs != NULL) {
+                if (have_lock) {
+                    (void)ledd_sysfs_set(led->plan->sysfs,
+                                         led->plan->value[state]);
+                }
+            } else {
+                ledd_stage_reg(led->plan->shadow, led->plan->mask,
+                               led->plan->bits[state]);
+            }
+        }
+
+        if (next != LLONG_MAX) {
+            ledd_wheel_add(&blink_wheel, &group->timer, next);
+        }
+    }
+} /* ledd_blink_run() */
+
+/************************************************************************//**
+ * Function that sets an LED class device to its state. The write is a
+ *     pwrite() to a file opened when the subsystem was added, so it is done
+ *     right away, and the LED status is set from its result.
+ *
+ * Logic:
+ *     - A flashing LED with a plain on/off pattern is handed to the kernel
+ *       timer trigger, so ledd runs no timer for it; other patterns are
+ *       stepped by the blink group for the pattern
+ *     - Else the brightness for the state is written
+ *
+ * Returns: void
+ ***************************************************************************/
+static void
+ledd_write_sysfs_led(struct locl_led *led)
+{
+    const struct ledd_led_plan *plan = led->plan;
+    const struct ledd_pattern *pattern;
+    unsigned long long n_writes = plan->sysfs->n_writes;
+    unsigned int on_ms, off_ms;
+    int state = led->state;
+    int error;
+
+    pattern = led->pattern;
+    if (pattern == NULL) {
+        pattern = ledd_pattern_builtin(LEDD_PATTERN_DEFAULT);
+    }
+
+    if (state == LED_STATE_FLASHING
+        && ledd_pattern_is_blink(pattern, &on_ms, &off_ms)) {
+        ledd_blink_stop(led);
+        error = ledd_sysfs_blink(plan->sysfs, plan->value[LED_STATE_ON],
+                                 on_ms, off_ms);
+    } else {
+        if (state == LED_STATE_FLASHING) {
+            state = ledd_blink_start(led, pattern)
+                    ? LED_STATE_ON : LED_STATE_OFF;
+        } else {
+            ledd_blink_stop(led);
+        }
+        error = ledd_sysfs_set(plan->sysfs, plan->value[state]);
+    }
+
+    if (plan->sysfs->n_writes == n_writes) {
+        bus_stats.sysfs_avoided++;
+        COVERAGE_INC(ledd_write_skipped);
+    } else {
+        bus_stats.sysfs_writes += plan->sysfs->n_writes - n_writes;
+    }
+
+    /* not waiting on a bus write any more */
+    list_remove(&led->write_node);
+    list_init(&led->write_node);
+
+    ledd_set_write_status(led, error == 0);
+} /* ledd_write_sysfs_led() */
+
+/************************************************************************//**
+ * Function that sets the LED to the value specified in ovsdb state variable.
+ *     The value is merged into the write batch; the register is written
+ *     by the bus worker, and the LED status updated when that completes.
+ *
+ * Logic:
+ *     - Looks up the value for the state in the LED write plan; flashing
+ *       LEDs with a pattern, or without a hardware flashing setting, join
+ *       the blink group for their pattern and start in the current step
+ *       of the group
+ *     - Merges the LED bits into the bits batched for the register
+ *     - Adds the register and the LED to the write batch
+ *
+ * Returns: True if the LED was queued, else False for any failure
+ ***************************************************************************/
+bool
+ledd_write_led(struct locl_subsystem *subsys, struct locl_led *led)
+{
+    const struct ledd_led_plan *plan = led->plan;
+    const struct ledd_pattern *pattern;
+    int state;
+
+    if (!plan->valid) {
+        VLOG_DBG("ledd_write: no write plan for %s", led->name);
+        return (false);
+    }
+
+    if ((unsigned int)led->state >= LEDD_NUM_STATES) {
+        VLOG_WARN("Invalid state %d for subsystem %s, LED %s",
+                led->state, subsys->name, led->name);
+        return(false);
+    }
+
+    /* A hot standby writes LED class devices when it takes over. */
+    if (plan->sysfs != NULL) {
+        if (have_lock) {
+            ledd_write_sysfs_led(led);
+        }
+        return(true);
+    }
+
+    /* Hardware without a flashing setting is blinked in software. */
+    pattern = led->pattern;
+    if (pattern == NULL && plan->soft_blink) {
+        pattern = ledd_pattern_builtin(LEDD_PATTERN_DEFAULT);
+    }
+
+    state = led->state;
+    if (state == LED_STATE_FLASHING && pattern != NULL) {
+        state = ledd_blink_start(led, pattern) ? LED_STATE_ON : LED_STATE_OFF;
+    } else {
+        ledd_blink_stop(led);
+    }
+
+    ledd_stage_reg(plan->shadow, plan->mask, plan->bits[state]);
+
+    list_remove(&led->write_node);
+    list_push_back(&batch_leds, &led->write_node);
+
+    return(true);
+} /* ledd_write_led() */
+
+/* order registers by subsystem, device and address */
+static int
+ledd_reg_compare(const void *a_, const void *b_)
+{
+    const struct ledd_reg *a = *(const struct ledd_reg **)a_;
+    const struct ledd_reg *b = *(const struct ledd_reg **)b_;
+    int cmp;
+
+    cmp = strcmp(a->subsystem->name, b->subsystem->name);
+    if (cmp == 0) {
+        cmp = strcmp(a->device, b->device);
+    }
+    if (cmp == 0) {
+        cmp = a->reg < b->reg ? -1 : a->reg > b->reg;
+    }
+
+    return(cmp);
+} /* ledd_reg_compare() */
+
+/************************************************************************//**
+ * Function that submits the registers in the write batch to the bus
+ *     workers. The status of the LEDs that were waiting on them is set
+ *     when the writes complete.
+ *
+ * Logic:
+ *     - registers not read yet stay in the batch, until the read is done
+ *       (their LEDs fail if the read failed)
+ *     - skip registers whose value did not change
+ *     - sort the rest by subsystem, device and address
+ *     - submit each run of consecutive registers on the same device as
+ *       a single job (or each register on its own, if block writes are
+ *       disabled); registers whose worker is full stay in the batch
+ *     - attach each batched LED to the last write of its register, or
+ *       set its status right away if its register has no write in flight
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+ledd_flush_writes(void)
+{
+    struct ledd_reg **regs;
+    struct ledd_reg *reg, *reg_next;
+    struct locl_led *led, *led_next;
+    size_t n_regs = 0;
+    size_t i, j;
+
+    if (list_is_empty(&batch_regs) && list_is_empty(&batch_leds)) {
+        return;
+    }
+
+    regs = xmalloc(list_size(&batch_regs) * sizeof *regs);
+    LIST_FOR_EACH_SAFE(reg, reg_next, batch_node, &batch_regs) {
+        if (!reg->valid) {
+            if (reg->read_failed) {
+                /* Give up on this batch, and re-read on the next one. */
+                reg->read_failed = false;
+                ledd_unbatch_reg(reg);
+            } else if (!reg->reading) {
+                (void)ledd_submit_job(LEDD_IO_READ, &reg, 1);
+            }
+        } else if (ledd_reg_next(reg) == reg->queued) {
+            bus_stats.writes_avoided++;
+            COVERAGE_INC(ledd_write_skipped);
+            ledd_unbatch_reg(reg);
+        } else {
+            regs[n_regs++] = reg;
+        }
+    }
+
+    qsort(regs, n_regs, sizeof *regs, ledd_reg_compare);
+
+    for (i = 0; i < n_regs; i = j) {
+        uint32_t byte_count = regs[i]->size;
+
+        /* Find the run of registers that can share one transaction. */
+        for (j = i + 1; block_writes && j < n_regs; j++) {
+            if (regs[j]->subsystem != regs[i]->subsystem
+                || strcmp(regs[j]->device, regs[i]->device)
+                || regs[j]->reg != regs[j - 1]->reg + regs[j - 1]->size
+                || byte_count + regs[j]->size > LEDD_IO_MAX_BYTES) {
+                break;
+            }
+            byte_count += regs[j]->size;
+        }
+        if (!block_writes) {
+            j = i + 1;
+        }
+
+        (void)ledd_submit_job(LEDD_IO_WRITE, &regs[i], j - i);
+    }
+
+    free(regs);
+
+    LIST_FOR_EACH_SAFE(led, led_next, write_node, &batch_leds) {
+        reg = led->plan->shadow;
+        if (reg->dirty) {
+            continue;
+        }
+
+        list_remove(&led->write_node);
+        if (reg->last_job != NULL) {
+            list_push_back(&reg->last_job->leds, &led->write_node);
+        } else {
+            list_init(&led->write_node);
+            ledd_set_write_status(led, reg->valid);
+        }
+    }
+} /* ledd_flush_writes() */
+
+/* initialize the subsystem data */
+static void
+init_subsystems(void)
+{
+    shash_init(&subsystem_data);
+    shash_init(&led_index);
+} /* init_subsystems() */
+
+enum ovsrec_led_status_e
+ledd_status_to_enum(char *status)
+{
+    size_t i;
+
+    if (status == NULL) {
+        return(LED_STATUS_UNINITIALIZED);
+    }
+
+    for (i = 0; i < sizeof(led_status_strings)/sizeof(const char *); i++) {
+        if (strcmp(led_status_strings[i], status) == 0) {
+            return( (enum ovsrec_led_status_e)i );
+        }
+    }
+
+    return(LED_STATUS_UNINITIALIZED);
+
+} /* ledd_status_to_enum() */
+
+enum ovsrec_led_state_e
+ledd_state_to_enum(char *state)
+{
+    size_t i;
+
+    if (state == NULL) {
+        return(LED_STATE_OFF);
+    }
+
+    for (i = 0; i < sizeof(led_state_strings)/sizeof(const char *); i++) {
+        if (strcmp(led_state_strings[i], state) == 0) {
+            return( (enum ovsrec_led_state_e)i );
+        }
+    }
+
+    return(LED_STATE_OFF);
+
+} /* ledd_state_to_enum() */
+
+static const char *
+ledd_state_to_string(enum ovsrec_led_state_e state)
+{
+    if ((unsigned int)state <
+                sizeof(led_state_strings)/sizeof(const char *)) {
+        return(led_state_strings[state]);
+    } else {
+        return(led_state_strings[LED_STATE_OFF]);
+    }
+} /* ledd_state_to_string() */
+
+static const char *
+ledd_status_to_string(enum ovsrec_led_status_e status)
+{
+    if ((unsigned int)status < sizeof(led_status_strings)/sizeof(const char *)){
+        return(led_status_strings[status]);
+    } else {
+        return(led_status_strings[LED_STATUS_UNINITIALIZED]);
+    }
+} /* ledd_status_to_string() */
+
+static void
+ledd_unixctl_dump(struct unixctl_conn *conn, int argc OVS_UNUSED,
+                          const char *argv[] OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    struct shash_node *snode;
+    struct shash_node *lnode;
+    struct ledd_blink_group *group;
+    struct ledd_reg *reg;
+
+    ledd_prof_wakeup(LEDD_WAKEUP_UNIXCTL);
+
+    ds_put_cstr(&ds, "Support Dump for Platform LED Daemon (ops-ledd)\n");
+    ds_put_format(&ds, "\nTransaction in flight: %s\n",
+                  commit_txn != NULL ? "yes" : "no");
+    ds_put_format(&ds, "Pending LED status writes: %"PRIuSIZE"\n",
+                  list_size(&dirty_leds) + list_size(&rowless_leds));
+    ds_put_format(&ds, "Bus register reads: %llu (%llu avoided)\n",
+                  bus_stats.reads, bus_stats.reads_avoided);
+    ds_put_format(&ds, "Bus register writes: %llu (%llu avoided)\n",
+                  bus_stats.writes, bus_stats.writes_avoided);
+    ds_put_format(&ds, "Bus block writes: %llu, LED writes combined: %llu\n",
+                  bus_stats.block_writes, bus_stats.writes_combined);
+    ds_put_format(&ds, "LED class writes: %llu (%llu LED writes avoided)\n",
+                  bus_stats.sysfs_writes, bus_stats.sysfs_avoided);
+    ledd_io_dump(&ds);
+    ledd_desc_dump(&ds);
+
+    HMAP_FOR_EACH(group, node, &blink_groups) {
+        ds_put_format(&ds, "Pattern %s: %"PRIuSIZE" LEDs", group->pattern->name,
+                      list_size(&group->leds));
+        if (ledd_wheel_is_scheduled(&group->timer)) {
+            ds_put_format(&ds, ", next step in %lld ms\n",
+                          group->timer.when - time_msec());
+        } else {
+            ds_put_cstr(&ds, ", done\n");
+        }
+    }
+
+    SHASH_FOR_EACH(snode, &subsystem_data) {
+        struct locl_subsystem *subsystem = (struct locl_subsystem *)snode->data;
+
+        ds_put_format(&ds, "\nSubsystem: %s\n", subsystem->name);
+
+        HMAP_FOR_EACH(reg, node, &subsystem->led_regs) {
+            if (reg->valid) {
+                ds_put_format(&ds, "\tRegister %s 0x%x: 0x%x",
+                              reg->device, reg->reg, reg->value);
+            } else {
+                ds_put_format(&ds, "\tRegister %s 0x%x: unknown",
+                              reg->device, reg->reg);
+            }
+            if (reg->n_inflight > 0) {
+                ds_put_format(&ds, " (%u jobs in flight, 0x%x queued)",
+                              reg->n_inflight, reg->queued);
+            }
+            ds_put_char(&ds, '\n');
+        }
+
+        SHASH_FOR_EACH(lnode, &(subsystem->subsystem_leds)) {
+            struct locl_led *led = (struct locl_led *)lnode->data;
+
+            ds_put_format(&ds, "\tLED name: %s\n", led->name);
+            ds_put_format(&ds, "\tLED type: %s\n", led->type);
+            if (led->plan->sysfs != NULL) {
+                ds_put_format(&ds, "\tLED class device: %s\n",
+                              led->plan->sysfs->path);
+            } else if (led->plan->valid) {
+                ds_put_format(&ds, "\tLED register: %s 0x%x mask 0x%x\n",
+                              led->plan->device, led->plan->reg,
+                              led->plan->mask);
+            }
+            ds_put_format(&ds, "\tLED state: %s\n",
+                                        ledd_state_to_string(led->state));
+            if (led->blink != NULL) {
+                ds_put_format(&ds, "\tLED pattern: %s\n",
+                              led->blink->pattern->name);
+            }
+            ds_put_format(&ds, "\tLED status: %s\n",
+                                        ledd_status_to_string(led->status));
+        }
+    }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+} /* ledd_unixctl_dump() */
+
+/* format an interval between two stage times (us) in ms, or "-" if the
+   later stage was not reached */
+static void
+ledd_put_interval(struct ds *ds, long long int from, long long int to)
+{
+    if (from != 0 && to != 0) {
+        ds_put_format(ds, " %9.1f", (to - from) / 1000.0);
+    } else {
+        ds_put_format(ds, " %9s", "-");
+    }
+} /* ledd_put_interval() */
+
+/************************************************************************//**
+ * Function that shows how long each subsystem took to come up, broken
+ *     down by loading stage, how long its LED rows took to be published
+ *     once it was set up, and how long the daemon took to first drive an
+ *     LED.
+ *
+ * Returns: void
+ ***************************************************************************/
+static void
+ledd_unixctl_startup(struct unixctl_conn *conn, int argc OVS_UNUSED,
+                     const char *argv[] OVS_UNUSED, void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    struct shash_node *snode;
+
+    ledd_prof_wakeup(LEDD_WAKEUP_UNIXCTL);
+
+    ds_put_format(&ds, "Loader threads: %d\n", ledd_load_n_threads());
+    if (first_led_time != 0) {
+        ds_put_format(&ds, "Time to first LED: %.1f ms\n",
+                      (first_led_time - start_time) / 1000.0);
+    } else {
+        ds_put_cstr(&ds, "Time to first LED: -\n");
+    }
+    ds_put_format(&ds, "LEDs restored from db: %llu\n", warm_leds);
+    ds_put_format(&ds, "Lock: %s (%s)\n",
+                  have_lock ? "held"
+                  : hot_standby ? "standing by" : "not held", lock_name);
+    if (shard.spec != NULL) {
+        ds_put_format(&ds, "Shard: %s, %"PRIuSIZE" subsystems, %s\n",
+                      shard.spec, shash_count(&subsystem_data),
+                      shard_ready_set ? "ready" : "not ready");
+        ds_put_format(&ds, "Shards ready: %d of %"PRIuSIZE"\n",
+                      ledd_count_ready_shards(), sset_count(&all_shards));
+    }
+    if (takeover_time >= 0) {
+        ds_put_format(&ds, "Last takeover: %.1f ms (%u takeovers)\n",
+                      takeover_time / 1000.0, n_takeovers);
+    } else {
+        ds_put_cstr(&ds, "Last takeover: -\n");
+    }
+
+    ds_put_format(&ds, "\n%-20s %9s %9s %9s %9s %9s %9s %9s %9s\n",
+                  "Subsystem (ms)", "queued", "digest", "files", "devices",
+                  "leds", "setup", "total", "publish");
+    SHASH_FOR_EACH(snode, &subsystem_data) {
+        const struct locl_subsystem *subsystem = snode->data;
+        const struct ledd_load_times *t = &subsystem->load_times;
+
+        ds_put_format(&ds, "%-20s", subsystem->name);
+        ledd_put_interval(&ds, t->queued, t->started);
+        ledd_put_interval(&ds, t->started, t->hashed);
+        ledd_put_interval(&ds, t->hashed, t->added);
+        ledd_put_interval(&ds, t->added, t->devices);
+        ledd_put_interval(&ds, t->devices, t->leds);
+        ledd_put_interval(&ds, t->leds != 0 ? t->leds : t->hashed,
+                          t->finished);
+        ledd_put_interval(&ds, t->queued, t->finished);
+        ledd_put_interval(&ds, t->finished, t->published);
+        if (subsystem->desc != NULL) {
+            ds_put_cstr(&ds, subsystem->desc->from_image
+                             ? " (image)" : " (yaml)");
+        }
+        if (subsystem->desc != NULL
+            && strcmp(subsystem->desc->name, subsystem->name)) {
+            ds_put_format(&ds, " (shared with %s)", subsystem->desc->name);
+        }
+        if (subsystem->subsys_status == LEDD_SUBSYS_STATUS_LOADING) {
+            ds_put_cstr(&ds, " (loading)");
+        } else if (subsystem->subsys_status == LEDD_SUBSYS_STATUS_IGNORE) {
+            ds_put_cstr(&ds, " (failed)");
+        }
+        ds_put_char(&ds, '\n');
+    }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+} /* ledd_unixctl_startup() */
+
+/************************************************************************//**
+ * Function that shows the latency of LED state changes, by subsystem and
+ *     by stage, or resets it with "reset".
+ *
+ * Returns: void
+ ***************************************************************************/
+static void
+ledd_unixctl_stats(struct unixctl_conn *conn, int argc, const char *argv[],
+                   void *aux OVS_UNUSED)
+{
+    struct ledd_hist all[LEDD_NUM_STAGES];
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    const struct shash_node **nodes;
+    struct shash_node *snode;
+    size_t i, n;
+    int stage;
+
+    ledd_prof_wakeup(LEDD_WAKEUP_UNIXCTL);
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset")) {
+            unixctl_command_reply_error(conn, "unknown argument");
+            return;
+        }
+        SHASH_FOR_EACH(snode, &subsystem_data) {
+            struct locl_subsystem *subsystem = snode->data;
+
+            for (stage = 0; stage < LEDD_NUM_STAGES; stage++) {
+                ledd_hist_reset(&subsystem->latency[stage]);
+            }
+        }
+        stats_reset_time = time_usec();
+        unixctl_command_reply(conn, NULL);
+        return;
+    }
+
+    memset(all, 0, sizeof all);
+    ds_put_format(&ds, "LED state change latency (us) over the last %.1f s\n",
+                  (time_usec() - stats_reset_time) / 1e6);
+    ds_put_format(&ds, "\n%-20s %-8s %8s %8s %8s %8s %8s %8s %8s %8s\n",
+                  "Subsystem", "Stage", "count", "min", "mean", "p50", "p90",
+                  "p99", "p99.9", "max");
+
+    nodes = shash_sort(&subsystem_data);
+    n = shash_count(&subsystem_data);
+    for (i = 0; i < n; i++) {
+        const struct locl_subsystem *subsystem = nodes[i]->data;
+
+        for (stage = 0; stage < LEDD_NUM_STAGES; stage++) {
+            ds_put_format(&ds, "%-20s %-8s ", stage ? "" : subsystem->name,
+                          stage_names[stage]);
+            ledd_hist_format(&ds, &subsystem->latency[stage]);
+            ds_put_char(&ds, '\n');
+            ledd_hist_merge(&all[stage], &subsystem->latency[stage]);
+        }
+    }
+    free(nodes);
+
+    if (n > 1) {
+        for (stage = 0; stage < LEDD_NUM_STAGES; stage++) {
+            ds_put_format(&ds, "%-20s %-8s ", stage ? "" : "(all)",
+                          stage_names[stage]);
+            ledd_hist_format(&ds, &all[stage]);
+            ds_put_char(&ds, '\n');
+        }
+    }
+    for (stage = 0; stage < LEDD_NUM_STAGES; stage++) {
+        ledd_hist_reset(&all[stage]);
+    }
+
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+} /* ledd_unixctl_stats() */
+
+/************************************************************************//**
+ * Function that shows where the main loop spends its time and why it
+ *     wakes up, or resets the profile with "reset".
+ *
+ * Returns: void
+ ***************************************************************************/
+static void
+ledd_unixctl_profile(struct unixctl_conn *conn, int argc, const char *argv[],
+                     void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+
+    ledd_prof_wakeup(LEDD_WAKEUP_UNIXCTL);
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "reset")) {
+            unixctl_command_reply_error(conn, "unknown argument");
+        } else {
+            ledd_prof_reset();
+            unixctl_command_reply(conn, NULL);
+        }
+        return;
+    }
+
+    ledd_prof_show(&ds);
+    unixctl_command_reply(conn, ds_cstr(&ds));
+    ds_destroy(&ds);
+} /* ledd_unixctl_profile() */
+
+/************************************************************************//**
+ * Function that shows the state of the LED I/O backend or, if options are
+ *     given, applies them to the backend.
+ *
+ * Returns: void
+ ***************************************************************************/
+static void
+ledd_unixctl_io_backend(struct unixctl_conn *conn, int argc,
+                        const char *argv[], void *aux OVS_UNUSED)
+{
+    struct ds ds = DS_EMPTY_INITIALIZER;
+    char *error;
+    int i;
+
+    ledd_prof_wakeup(LEDD_WAKEUP_UNIXCTL);
+
+    if (argc > 1) {
+        for (i = 1; i < argc; i++) {
+            ds_put_format(&ds, "%s%s", i > 1 ? "," : "", argv[i]);
+        }
+        error = ledd_io_configure(ds_cstr(&ds));
+        if (error != NULL) {
+            unixctl_command_reply_error(conn, error);
+            free(error);
+        } else {
+            unixctl_command_reply(conn, NULL);
+        }
+    } else {
+        ledd_io_show(&ds);
+        unixctl_command_reply(conn, ds_cstr(&ds));
+    }
+    ds_destroy(&ds);
+} /* ledd_unixctl_io_backend() */
+
+static void
+usage(void)
+{
+    printf("%s: OpenSwitch ledd daemon\n"
+           "usage: %s [OPTIONS] [DATABASE]\n"
+           "where DATABASE is a socket on which ovsdb-server is listening\n"
+           "      (default: \"unix:%s/db.sock\").\n",
+           program_name, program_name, ovs_rundir());
+    stream_usage("DATABASE", true, false, true);
+    daemon_usage();
+    vlog_usage();
+    printf("\nLED options:\n"
+           "  --disable-block-writes  write each LED register on its own\n"
+           "  --led-io=BACKEND[:OPTS] LED I/O backend: i2c (default), or sim\n"
+           "                          to emulate the LED devices in memory\n"
+           "  --disable-led-io        same as --led-io=sim\n"
+           "  --load-threads=N        load hw description files with N threads\n"
+           "                          (default: one per CPU core, up to %d)\n"
+           "  --led-image-dir=DIR     save compiled LED descriptions in DIR,\n"
+           "                          \"\" not to (default: %s)\n"
+           "  --sysfs-leds-dir=DIR    LED class directory for \"sysfs:\" LEDs\n"
+           "                          (default: %s)\n"
+           "  --coalesce-window=MS    apply a burst of db changes, made less\n"
+           "                          than MS apart, in one pass (default: %d,\n"
+           "                          0 to apply each change on its own)\n"
+           "  --coalesce-max=MS       but never hold a change for more than MS\n"
+           "                          (default: %d)\n"
+           "  --bringup-chunk=N       write and publish at most N LEDs of new\n"
+           "                          subsystems per pass and per transaction\n"
+           "                          (default: %d, 0 for no limit)\n"
+           "  --hot-standby           without the lock, keep the LED state\n"
+           "                          current, to take over at once\n"
+           "  --shard=SHARD           handle only the subsystems of SHARD: a\n"
+           "                          name pattern, or hash:A-B/N for the\n"
+           "                          names hashing into slots A to B of N\n"
+           "  --shards=SHARD,...      set cur_hw once all these shards are\n"
+           "                          ready (default: the --shard alone)\n"
+           "  --lock-name=NAME        OVSDB lock to take (default: %s, or\n"
+           "                          %s_shard_HASH with --shard)\n",
+           LEDD_LOAD_MAX_THREADS, LEDD_IMAGE_DIR, LEDD_SYSFS_DIR,
+           LEDD_COALESCE_WINDOW_MS, LEDD_COALESCE_MAX_MS, LEDD_BRINGUP_CHUNK,
+           LEDD_LOCK_NAME, LEDD_LOCK_NAME);
+    printf("\nOther options:\n"
+           "  --unixctl=SOCKET        override default control socket name\n"
+           "  -h, --help              display this help message\n"
+           "  -V, --version           display version information\n");
+    exit(EXIT_SUCCESS);
+} /* usage() */
+
+static char *
+parse_options(int argc, char *argv[], char **unixctl_pathp)
+{
+    enum {
+        OPT_PEER_CA_CERT = UCHAR_MAX + 1,
+        OPT_UNIXCTL,
+        VLOG_OPTION_ENUMS,
+        OPT_BOOTSTRAP_CA_CERT,
+        OPT_ENABLE_DUMMY,
+        OPT_DISABLE_SYSTEM,
+        DAEMON_OPTION_ENUMS,
+        OPT_DPDK,
+        OPT_DISABLE_BLOCK_WRITES,
+        OPT_LOAD_THREADS,
+        OPT_LED_IMAGE_DIR,
+        OPT_DISABLE_LED_IO,
+        OPT_LED_IO,
+        OPT_SYSFS_LEDS_DIR,
+        OPT_COALESCE_WINDOW,
+        OPT_COALESCE_MAX,
+        OPT_BRINGUP_CHUNK,
+        OPT_HOT_STANDBY,
+        OPT_SHARD,
+        OPT_SHARDS,
+        OPT_LOCK_NAME,
+    };
+    static const struct option long_options[] = {
+        {"help",        no_argument, NULL, 'h'},
+        {"version",     no_argument, NULL, 'V'},
+        {"unixctl",     required_argument, NULL, OPT_UNIXCTL},
+        DAEMON_LONG_OPTIONS,
+        VLOG_LONG_OPTIONS,
+        STREAM_SSL_LONG_OPTIONS,
+        {"peer-ca-cert", required_argument, NULL, OPT_PEER_CA_CERT},
+        {"bootstrap-ca-cert", required_argument, NULL, OPT_BOOTSTRAP_CA_CERT},
+        {"disable-block-writes", no_argument, NULL, OPT_DISABLE_BLOCK_WRITES},
+        {"load-threads", required_argument, NULL, OPT_LOAD_THREADS},
+        {"led-image-dir", required_argument, NULL, OPT_LED_IMAGE_DIR},
+        {"disable-led-io", no_argument, NULL, OPT_DISABLE_LED_IO},
+        {"led-io", required_argument, NULL, OPT_LED_IO},
+        {"sysfs-leds-dir", required_argument, NULL, OPT_SYSFS_LEDS_DIR},
+        {"coalesce-window", required_argument, NULL, OPT_COALESCE_WINDOW},
+        {"coalesce-max", required_argument, NULL, OPT_COALESCE_MAX},
+        {"bringup-chunk", required_argument, NULL, OPT_BRINGUP_CHUNK},
+        {"hot-standby", no_argument, NULL, OPT_HOT_STANDBY},
+        {"shard",       required_argument, NULL, OPT_SHARD},
+        {"shards",      required_argument, NULL, OPT_SHARDS},
+        {"lock-name",   required_argument, NULL, OPT_LOCK_NAME},
+        {NULL, 0, NULL, 0},
+    };
+    char *short_options = long_options_to_short_options(long_options);
+
+    for (;;) {
+        int c;
+
+        c = getopt_long(argc, argv, short_options, long_options, NULL);
+        if (c == -1) {
+            break;
+        }
+
+        switch (c) {
+        case 'h':
+            usage();
+
+        case 'V':
+            ovs_print_version(OFP10_VERSION, OFP10_VERSION);
+            exit(EXIT_SUCCESS);
+
+        case OPT_UNIXCTL:
+            *unixctl_pathp = optarg;
+            break;
+
+        VLOG_OPTION_HANDLERS
+        DAEMON_OPTION_HANDLERS
+        STREAM_SSL_OPTION_HANDLERS
+
+        case OPT_PEER_CA_CERT:
+            stream_ssl_set_peer_ca_cert_file(optarg);
+            break;
+
+        case OPT_BOOTSTRAP_CA_CERT:
+            stream_ssl_set_ca_cert_file(optarg, true);
+            break;
+
+        case OPT_DISABLE_BLOCK_WRITES:
+            block_writes = false;
+            break;
+
+        case OPT_LOAD_THREADS:
+            if (!str_to_int(optarg, 10, &load_threads) || load_threads < 0) {
+                ovs_fatal(0, "--load-threads argument must be a number");
+            }
+            break;
+
+        case OPT_LED_IMAGE_DIR:
+            led_image_dir = optarg;
+            break;
+
+        case OPT_DISABLE_LED_IO:
+            led_io = "sim";
+            break;
+
+        case OPT_LED_IO:
+            led_io = optarg;
+            break;
+
+        case OPT_SYSFS_LEDS_DIR:
+            ledd_sysfs_set_dir(optarg);
+            break;
+
+        case OPT_COALESCE_WINDOW:
+            if (!str_to_int(optarg, 10, &coalesce_window)
+                || coalesce_window < 0) {
+                ovs_fatal(0, "--coalesce-window argument must be a number");
+            }
+            break;
+
+        case OPT_COALESCE_MAX:
+            if (!str_to_int(optarg, 10, &coalesce_max) || coalesce_max < 0) {
+                ovs_fatal(0, "--coalesce-max argument must be a number");
+            }
+            break;
+
+        case OPT_BRINGUP_CHUNK:
+            if (!str_to_int(optarg, 10, &bringup_chunk) || bringup_chunk < 0) {
+                ovs_fatal(0, "--bringup-chunk argument must be a number");
+            }
+            break;
+
+        case OPT_HOT_STANDBY:
+            hot_standby = true;
+            break;
+
+        case OPT_SHARD: {
+            char *error;
+
+            ledd_shard_destroy(&shard);
+            error = ledd_shard_parse(&shard, optarg);
+            if (error != NULL) {
+                ovs_fatal(0, "--shard: %s", error);
+            }
+            break;
+        }
+
+        case OPT_SHARDS: {
+            char *copy = xstrdup(optarg);
+            char *save_ptr = NULL;
+            char *spec;
+
+            for (spec = strtok_r(copy, ",", &save_ptr); spec != NULL;
+                 spec = strtok_r(NULL, ",", &save_ptr)) {
+                struct ledd_shard check;
+                char *error = ledd_shard_parse(&check, spec);
+
+                if (error != NULL) {
+                    ovs_fatal(0, "--shards: %s", error);
+                }
+                ledd_shard_destroy(&check);
+                sset_add(&all_shards, spec);
+            }
+            free(copy);
+            break;
+        }
+
+        case OPT_LOCK_NAME:
+            if (!ledd_shard_is_lock_name(optarg)) {
+                ovs_fatal(0, "--lock-name argument must be letters, digits "
+                          "and _, not starting with a digit");
+            }
+            free(lock_name);
+            lock_name = xstrdup(optarg);
+            break;
+
+        case '?':
+            exit(EXIT_FAILURE);
+
+        default:
+            abort();
+        }
+    }
+    free(short_options);
+
+    argc -= optind;
+    argv += optind;
 
     switch (argc) {
     case 0:
@@ -438,416 +1695,1142 @@ parse_options(int argc, char *argv[], char **unixctl_pathp)
     case 1:
         return xstrdup(argv[0]);
 
-    default:
-        VLOG_FATAL("at most one non-option argument accepted; "
-                   "use --help for usage");
+    default:
+        VLOG_FATAL("at most one non-option argument accepted; "
+                   "use --help for usage");
+    }
+} /* parse_options() */
+
+static void
+ledd_exit(struct unixctl_conn *conn, int argc OVS_UNUSED,
+                  const char *argv[] OVS_UNUSED, void *exiting_)
+{
+    bool *exiting = exiting_;
+
+    ledd_prof_wakeup(LEDD_WAKEUP_UNIXCTL);
+    *exiting = true;
+    unixctl_command_reply(conn, NULL);
+} /* ledd_exit() */
+
+
+/* set the "marked" value for each subsystem to false. */
+static void
+ledd_unmark_subsystems(void)
+{
+    struct shash_node *node;
+
+    SHASH_FOR_EACH(node, &subsystem_data) {
+        struct locl_subsystem *subsystem = (struct locl_subsystem *)node->data;
+        subsystem->marked = false;
+    }
+} /* ledd_unmark_subsystems() */
+
+
+
+/* ************ OVS  ******************** */
+
+/* perform general initialization, including registering for notifications */
+static void
+ledd_init(const char *remote)
+{
+    char *error;
+    int retval;
+
+    /* initialize subsystems */
+    init_subsystems();
+
+    /* initialize the hardware description loader and the bus workers */
+    start_time = time_usec();
+    stats_reset_time = start_time;
+    ledd_prof_init();
+    ledd_load_init(load_threads, led_image_dir);
+    error = ledd_io_init(led_io);
+    if (error != NULL) {
+        ovs_fatal(0, "--led-io: %s", error);
+    }
+    ledd_wheel_init(&blink_wheel, LEDD_BLINK_TICK_MS);
+
+    /* each shard takes a lock of its own, so the shards run side by side */
+    if (lock_name == NULL) {
+        lock_name = (shard.spec != NULL
+                     ? ledd_shard_lock_name(&shard, LEDD_LOCK_NAME)
+                     : xstrdup(LEDD_LOCK_NAME));
+    }
+    if (shard.spec != NULL) {
+        shard_daemon_name = xasprintf("%s%c%s", NAME_IN_DAEMON_TABLE,
+                                      LEDD_SHARD_DAEMON_SEP, shard.spec);
+        if (sset_is_empty(&all_shards)) {
+            sset_add(&all_shards, shard.spec);
+        } else if (!sset_contains(&all_shards, shard.spec)) {
+            ovs_fatal(0, "--shards must list the --shard of this process");
+        }
+    } else if (!sset_is_empty(&all_shards)) {
+        ovs_fatal(0, "--shards needs --shard");
+    }
+
+    idl = ovsdb_idl_create(remote, &ovsrec_idl_class, false, true);
+    idl_seqno = ovsdb_idl_get_seqno(idl);
+    ovsdb_idl_set_lock(idl, lock_name);
+    /* Commenting this out to allow read/write for state column. */
+    /* ovsdb_idl_verify_write_only(idl); */
+
+    /* register interest in daemon table */
+    ovsdb_idl_add_table(idl, &ovsrec_table_daemon);
+    ovsdb_idl_add_column(idl, &ovsrec_daemon_col_name);
+    ovsdb_idl_add_column(idl, &ovsrec_daemon_col_cur_hw);
+    ovsdb_idl_omit_alert(idl, &ovsrec_daemon_col_cur_hw);
+
+    /* register interest in all led columns */
+    ovsdb_idl_add_table(idl, &ovsrec_table_led);
+    ovsdb_idl_add_column(idl, &ovsrec_led_col_id);
+    ovsdb_idl_omit_alert(idl, &ovsrec_led_col_id);
+    ovsdb_idl_add_column(idl, &ovsrec_led_col_state);
+    ovsdb_idl_add_column(idl, &ovsrec_led_col_status);
+    ovsdb_idl_omit_alert(idl, &ovsrec_led_col_status);
+
+    /* track led:state so only changed rows are processed, and led:id
+       to keep the index of LED rows by id */
+    ovsdb_idl_track_add_column(idl, &ovsrec_led_col_state);
+    ovsdb_idl_track_add_column(idl, &ovsrec_led_col_id);
+    ledd_row_index_init(&led_rows);
+
+    /* register interest in the subsystems. this process needs the
+       name and hw_desc_dir fields. the name value must be unique within
+       all subsystems (used as a key). the hw_desc_dir needs to be populated
+       with the location where the hardware description files are located */
+    ovsdb_idl_add_table(idl, &ovsrec_table_subsystem);
+    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_other_config);
+    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_name);
+    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_hw_desc_dir);
+    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_leds);
+    ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_leds);
+
+    unixctl_command_register("ops-ledd/dump", "", 0, 0,
+                             ledd_unixctl_dump, NULL);
+    unixctl_command_register("ops-ledd/startup", "", 0, 0,
+                             ledd_unixctl_startup, NULL);
+    unixctl_command_register("ops-ledd/io-backend", "[option=value...]", 0,
+                             INT_MAX, ledd_unixctl_io_backend, NULL);
+    unixctl_command_register("ops-ledd/stats", "[reset]", 0, 1,
+                             ledd_unixctl_stats, NULL);
+    unixctl_command_register("ops-ledd/profile", "[reset]", 0, 1,
+                             ledd_unixctl_profile, NULL);
+
+    retval = event_log_init("LED");
+
+    if(retval < 0) {
+         VLOG_ERR("Event log initialization failed for LED");
+    }
+} /* ledd_init() */
+
+struct ovsrec_led *
+lookup_led(const char *name)
+{
+    return(CONST_CAST(struct ovsrec_led *,
+                      ledd_row_index_find(&led_rows, idl, name)));
+} /* lookup_led() */
+
+/************************************************************************//**
+ * Function that applies the state of an OVSDB LED row to the matching LED
+ *
+ * Logic:
+ *   if the state has changed   (User requested a state change)
+ *       queue the LED write in the write batch
+ *       if it cannot be written, update the LED status in ovsdb
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+process_led_change(struct locl_led *led, const struct ovsrec_led *ovs_led)
+{
+    struct locl_subsystem *subsys = led->subsystem;
+
+    led->row_uuid = ovs_led->header_.uuid;
+
+    /* If we were unable to process the hwdesc file for this subsys, return. */
+    if (subsys->subsys_status == LEDD_SUBSYS_STATUS_IGNORE) {
+        VLOG_DBG("subsys %s set to IGNORE",subsys->name);
+        return;
+    }
+
+    /* If no new state has been written into the db, there is nothing to do. */
+    if (led->state == ledd_state_to_enum(ovs_led->state)) {
+        return;
+    }
+
+    led->state = ledd_state_to_enum(ovs_led->state);
+
+    /* Time the change, from its delivery by the IDL until its status is
+       in the db. A change still in flight is superseded. A hot standby
+       does not time changes, as it does not apply them. */
+    if (have_lock) {
+        led->stamps[LEDD_STAMP_CHANGED] = idl_run_time;
+        led->stamps[LEDD_STAMP_WRITE] = time_usec();
+        led->stamps[LEDD_STAMP_WRITTEN] = 0;
+        ledd_record_latency(led, LEDD_STAGE_DISPATCH,
+                            led->stamps[LEDD_STAMP_CHANGED],
+                            led->stamps[LEDD_STAMP_WRITE]);
+    } else {
+        memset(led->stamps, 0, sizeof led->stamps);
+    }
+
+    /* If we have a valid type, write to the LED. The status is set when
+       the write batch is flushed. */
+    if (led->plan->valid) {
+        if (ledd_write_led(subsys, led)) {
+            return;
+        }
+        VLOG_WARN("ledd_write failed, %s",led->name);
+    } else {
+        VLOG_WARN("Unable to write LED %s, led type %s unknown",
+                led->name, led->type);
+    }
+
+    /* If there is a new status, push it to the db. */
+    memset(led->stamps, 0, sizeof led->stamps);
+    led->status = LED_STATUS_FAULT;
+    if (ledd_status_to_enum(ovs_led->status) != led->status) {
+        ledd_mark_status_dirty(led);
+    }
+} /* process_led_change() */
+
+/************************************************************************//**
+ * Function that processes the LED rows whose state changed since the last
+ *     pass, as reported by IDL change tracking.
+ *
+ * Logic:
+ *   foreach changed (inserted or modified) LED row
+ *       find the matching LED in the led index
+ *       process the change
+ *
+ * The cost is proportional to the number of changed rows, not to the
+ * number of LEDs or LED rows.
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+process_tracked_led_changes(void)
+{
+    const struct ovsrec_led *ovs_led;
+    struct locl_led *led;
+
+    OVSREC_LED_FOR_EACH_TRACKED(ovs_led, idl) {
+        COVERAGE_INC(ledd_led_row_change);
+
+        /* Deleted rows have nothing left to apply. */
+        if (ovsrec_led_row_get_seqno(ovs_led, OVSDB_IDL_CHANGE_DELETE) > 0) {
+            continue;
+        }
+
+        led = shash_find_data(&led_index, ovs_led->id);
+        if (led != NULL) {
+            process_led_change(led, ovs_led);
+        }
     }
-} /* parse_options() */
+} /* process_tracked_led_changes() */
 
+/************************************************************************//**
+ * Function that applies every LED row in OVSDB, regardless of change
+ *     tracking. Only used when (re)gaining the lock, since changes seen
+ *     while another process owned the LEDs were not applied. New
+ *     subsystems need no full pass: ledd_finish_subsystem() starts their
+ *     LEDs in the state of their rows.
+ *
+ * Returns:  void
+ ***************************************************************************/
 static void
-ledd_exit(struct unixctl_conn *conn, int argc OVS_UNUSED,
-                  const char *argv[] OVS_UNUSED, void *exiting_)
+process_all_led_rows(void)
 {
-    bool *exiting = exiting_;
-    *exiting = true;
-    unixctl_command_reply(conn, NULL);
-} /* ledd_exit() */
+    const struct ovsrec_led *ovs_led;
+    struct locl_led *led;
 
+    OVSREC_LED_FOR_EACH(ovs_led, idl) {
+        led = shash_find_data(&led_index, ovs_led->id);
+        if (led != NULL) {
+            process_led_change(led, ovs_led);
+        }
+    }
+} /* process_all_led_rows() */
 
-/* set the "marked" value for each subsystem to false. */
+/************************************************************************//**
+ * Function that creates a new locl_subsystem structure
+ *     when a new subsystem is found in ovsdb, and starts loading its
+ *     hardware description files in the loader thread pool. The subsystem
+ *     is set up by ledd_finish_subsystem() once they are loaded.
+ *
+ * Logic:
+ *      - create a new locl_subsystem structure, add to hash
+ *      - tag the subsystem as "unmarked" and as IGNORE
+ *      - queue the load of the hw desc files for the subsystem
+ *      - tag the subsystem as "marked" and LOADING
+ *
+ * Returns:  void
+ ***************************************************************************/
+void
+add_subsystem(const struct ovsrec_subsystem *ovsrec_subsys)
+{
+    struct locl_subsystem *lsubsys;
+    struct ledd_load *load;
+    const char *dir;
+
+    VLOG_DBG("Adding new subsystem %s", ovsrec_subsys->name);
+
+    lsubsys = (struct locl_subsystem *)malloc(sizeof(struct locl_subsystem));
+    memset(lsubsys, 0, sizeof(struct locl_subsystem));
+
+    (void)shash_add(&subsystem_data, ovsrec_subsys->name, (void *)lsubsys);
+
+    lsubsys->name = strdup(ovsrec_subsys->name);
+    lsubsys->ovs_uuid = ovsrec_subsys->header_.uuid;
+    lsubsys->marked = false;
+    lsubsys->subsys_status = LEDD_SUBSYS_STATUS_IGNORE;
+    lsubsys->parent_subsystem = NULL;  /* OPS_TODO: find parent subsystem */
+
+    shash_init(&lsubsys->subsystem_leds);
+    hmap_init(&lsubsys->led_regs);
+    shash_init(&lsubsys->patterns);
+    smap_init(&lsubsys->pattern_config);
+
+    /* use a default if the hw_desc_dir has not been populated */
+    dir = ovsrec_subsys->hw_desc_dir;
+
+    if (dir == NULL || strlen(dir) == 0) {
+        VLOG_ERR("No h/w description directory for subsystem %s",
+                                    ovsrec_subsys->name);
+        return;
+    }
+
+    /* since this is a new subsystem, load all of the hardware description
+       information about the LEDs (just for this subsystem), in parallel
+       with any other new subsystem. Subsystems with the same files share
+       the parsed data. */
+    load = ledd_load_create(ovsrec_subsys->name, dir);
+    ledd_load_submit(load);
+
+    lsubsys->marked = true;
+    lsubsys->subsys_status = LEDD_SUBSYS_STATUS_LOADING;
+
+    return;
+} /* add_subsystem() */
+
+/* write the default value of an LED of a new subsystem. The status is set
+   when the batch is flushed. */
 static void
-ledd_unmark_subsystems(void)
+ledd_bringup_write(struct locl_subsystem *lsubsys, struct locl_led *led)
+{
+    if (!ledd_write_led(lsubsys, led)) {
+        VLOG_WARN("ledd_write failed, %s", led->name);
+        led->status = LED_STATUS_FAULT;
+        ledd_mark_status_dirty(led);
+    }
+} /* ledd_bringup_write() */
+
+/************************************************************************//**
+ * Function that writes the default values of the LEDs of new subsystems
+ *     that were left for later passes, at most bringup_chunk per pass, so
+ *     a big subsystem does not hold up the main loop.
+ *
+ * Returns: void
+ ***************************************************************************/
+static void
+ledd_bringup_run(void)
 {
     struct shash_node *node;
+    size_t budget = bringup_chunk > 0 ? bringup_chunk : SIZE_MAX;
+
+    if (!bringup_more) {
+        return;
+    }
 
+    bringup_more = false;
     SHASH_FOR_EACH(node, &subsystem_data) {
-        struct locl_subsystem *subsystem = (struct locl_subsystem *)node->data;
-        subsystem->marked = false;
+        struct locl_subsystem *lsubsys = node->data;
+
+        if (lsubsys->subsys_status != LEDD_SUBSYS_STATUS_OK) {
+            continue;
+        }
+        while (lsubsys->n_written < lsubsys->n_bringup && budget > 0) {
+            ledd_bringup_write(lsubsys,
+                               lsubsys->bringup[lsubsys->n_written++]);
+            budget--;
+        }
+        bringup_more |= lsubsys->n_written < lsubsys->n_bringup;
     }
-} /* ledd_unmark_subsystems() */
+} /* ledd_bringup_run() */
+
+/************************************************************************//**
+ * Function that sets up a subsystem whose hardware description files have
+ *     been loaded, and sets its loc LEDs to their default values. Its other
+ *     LEDs are set by ledd_bringup_run() over the next passes, and all of
+ *     them are added into the ovsdb led table by the next transactions
+ *     (see ledd_publish_subsystem).
+ *
+ * Logic:
+ *      - tag the subsystem as IGNORE, if the files could not be loaded
+ *      - extract the LED information for this subsys from the compiled
+ *        image of its hw desc files. This includes names and types of
+ *        LEDs, and their supported states and settings.
+ *      - order the LEDs for bring-up, loc LEDs first
+ *      - foreach loc led
+ *          - write the default value to the LED
+ *      - tag the subsystem as OK and as pending publication
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+ledd_finish_subsystem(struct locl_subsystem *lsubsys, struct ledd_load *load)
+{
+    const struct shash_node **nodes;
+    const char *dir = load->dir;
+    int idx;
+    const struct ledd_image *image;
+    const struct ledd_desc *desc;
 
+    lsubsys->load_times = load->times;
+    lsubsys->subsys_status = LEDD_SUBSYS_STATUS_IGNORE;
 
+    if (load->rc != 0) {
+        VLOG_ERR("Unable to parse subsystem %s %s (in %s)",
+                 lsubsys->name, load->failed, dir);
+        return;
+    }
+    /* the descriptor may be shared with other subsystems of the same
+       model; its LED data is in its compiled image */
+    desc = lsubsys->desc = load->desc;
 
-/* ************ OVS  ******************** */
+    image = desc->image;
 
-/* perform general initialization, including registering for notifications */
+    /* get the # of LED types and LEDs found in the led file */
+    lsubsys->num_types = image->header->n_types;
+    lsubsys->num_leds = image->header->n_leds;
+
+    if ( (lsubsys->num_leds <= 0) || (lsubsys->num_types <= 0) ) {
+        VLOG_INFO("subsystem %s has no LED info", lsubsys->name);
+        /* no LEDs were set up, so there are none to tear down */
+        lsubsys->num_leds = 0;
+        return;
+    }
+
+    VLOG_DBG("There are %d LED types in subsystem %s", lsubsys->num_types,
+                             lsubsys->name);
+    log_event("LED_COUNT", EV_KV("count", "%d", lsubsys->num_types),
+        EV_KV("subsystem", "%s", lsubsys->name));
+    VLOG_DBG("There are %d LEDs in subsystem %s", lsubsys->num_leds,
+                             lsubsys->name);
+
+    lsubsys->led_plans = (struct ledd_led_plan *)
+                xcalloc(lsubsys->num_leds, sizeof(struct ledd_led_plan));
+
+    lsubsys->bringup = xcalloc(lsubsys->num_leds, sizeof *lsubsys->bringup);
+
+    /* walk through LEDs and compile their write plans */
+    for (idx = 0; idx < lsubsys->num_leds; idx++) {
+        char *led_name = NULL;
+        const struct ledd_image_led *led = &image->leds[idx];
+        const char *short_name = ledd_image_string(image, led->name);
+        const struct ovsrec_led *ovs_led;
+        struct locl_led *new_led;
+        struct ledd_led_plan *plan;
+
+        VLOG_DBG("Adding LED %s in subsystem %s", short_name,
+                                        lsubsys->name);
+
+        /* Create the new locl led struct and initialize it. */
+        asprintf(&led_name, "%s-%s", lsubsys->name, short_name);
+        new_led = (struct locl_led *)malloc(sizeof(struct locl_led));
+        new_led->name = led_name;
+        new_led->subsystem = lsubsys;
+        new_led->type = ledd_image_string(image, led->type);
+        new_led->state = LED_STATE_OFF;
+        new_led->status = LED_STATUS_OK;
+        uuid_zero(&new_led->row_uuid);
+
+        /* On a restart, the LED starts in the state of its row, which the
+           hardware should still be in, so it is not turned off and back
+           on; writes of values the hardware already has are skipped. */
+        ovs_led = lookup_led(led_name);
+        if (ovs_led != NULL) {
+            new_led->state = ledd_state_to_enum(ovs_led->state);
+            new_led->row_uuid = ovs_led->header_.uuid;
+            warm_leds++;
+        }
+        list_init(&new_led->status_node);
+        list_init(&new_led->write_node);
+        new_led->pattern = NULL;
+        new_led->blink = NULL;
+        memset(new_led->stamps, 0, sizeof new_led->stamps);
+        list_init(&new_led->blink_node);
+
+        plan = &lsubsys->led_plans[idx];
+        ledd_compile_led_plan(lsubsys, image, led, plan);
+        new_led->plan = plan;
+        if (!plan->valid) {
+            new_led->status = LED_STATUS_FAULT;
+        }
+
+        /* Add this new locl led to the led shash in subsystem shash */
+        shash_add(&lsubsys->subsystem_leds, short_name, (void *)new_led);
+        shash_add(&led_index, led_name, (void *)new_led);
+
+        /* loc LEDs go first; the others are placed once they are known */
+        if (!strcmp(new_led->type, LEDD_LED_TYPE_LOC)) {
+            lsubsys->bringup[lsubsys->n_loc++] = new_led;
+        }
+    }
+
+    /* the other LEDs follow in id order, so every run brings them up,
+       and publishes them, in the same chunks */
+    lsubsys->n_bringup = lsubsys->n_loc;
+    nodes = shash_sort(&lsubsys->subsystem_leds);
+    for (idx = 0; idx < shash_count(&lsubsys->subsystem_leds); idx++) {
+        struct locl_led *led = nodes[idx]->data;
+
+        if (strcmp(led->type, LEDD_LED_TYPE_LOC)) {
+            lsubsys->bringup[lsubsys->n_bringup++] = led;
+        }
+    }
+    free(nodes);
+
+    /* Write the loc LEDs now, so they work whatever the subsystem size. */
+    while (lsubsys->n_written < lsubsys->n_loc) {
+        ledd_bringup_write(lsubsys, lsubsys->bringup[lsubsys->n_written++]);
+    }
+    bringup_more |= lsubsys->n_written < lsubsys->n_bringup;
+
+    /* Update the state of the locl_subsystem structure */
+    lsubsys->subsys_status = LEDD_SUBSYS_STATUS_OK;
+    lsubsys->load_times.finished = time_usec();
+    if (first_led_time == 0) {
+        first_led_time = lsubsys->load_times.finished;
+    }
+    lsubsys->publish_pending = true;
+
+    return;
+} /* ledd_finish_subsystem() */
+
+/************************************************************************//**
+ * Function that applies the LED pattern keys of a subsystem other_config:
+ *
+ *     led_pattern:<name>=<pattern>   defines (or overrides) a pattern
+ *     led:<led>=<name>               selects the pattern the LED runs when
+ *                                    its state is "flashing"
+ *
+ * Logic:
+ *     - do nothing if the pattern keys did not change
+ *     - take the LEDs out of their blink groups, since the patterns they
+ *       run may be freed
+ *     - compile the patterns of the subsystem
+ *     - select the pattern of each LED, from the subsystem patterns or
+ *       else the built-in ones
+ *     - rewrite the flashing LEDs, so they start their new pattern
+ *
+ * Returns:  void
+ ***************************************************************************/
 static void
-ledd_init(const char *remote)
+ledd_update_patterns(struct locl_subsystem *subsys,
+                     const struct smap *other_config)
 {
-    int retval;
+    static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(5, 5);
+    struct smap config = SMAP_INITIALIZER(&config);
+    const struct smap_node *cnode;
+    struct shash_node *node, *next;
 
-    /* initialize subsystems */
-    init_subsystems();
+    SMAP_FOR_EACH(cnode, other_config) {
+        if (!strncmp(cnode->key, LEDD_PATTERN_KEY_PREFIX,
+                     strlen(LEDD_PATTERN_KEY_PREFIX))
+            || !strncmp(cnode->key, LEDD_LED_KEY_PREFIX,
+                        strlen(LEDD_LED_KEY_PREFIX))) {
+            smap_add(&config, cnode->key, cnode->value);
+        }
+    }
 
-    /* initialize the yaml handle */
-    yaml_handle = yaml_new_config_handle();
+    if (smap_equal(&config, &subsys->pattern_config)) {
+        smap_destroy(&config);
+        return;
+    }
+    smap_destroy(&subsys->pattern_config);
+    smap_clone(&subsys->pattern_config, &config);
+    smap_destroy(&config);
 
-    idl = ovsdb_idl_create(remote, &ovsrec_idl_class, false, true);
-    idl_seqno = ovsdb_idl_get_seqno(idl);
-    ovsdb_idl_set_lock(idl, "ops_ledd");
-    /* Commenting this out to allow read/write for state column. */
-    /* ovsdb_idl_verify_write_only(idl); */
+    SHASH_FOR_EACH(node, &subsys->subsystem_leds) {
+        struct locl_led *led = node->data;
 
-    /* register interest in daemon table */
-    ovsdb_idl_add_table(idl, &ovsrec_table_daemon);
-    ovsdb_idl_add_column(idl, &ovsrec_daemon_col_name);
-    ovsdb_idl_add_column(idl, &ovsrec_daemon_col_cur_hw);
-    ovsdb_idl_omit_alert(idl, &ovsrec_daemon_col_cur_hw);
+        ledd_blink_stop(led);
+        led->pattern = NULL;
+    }
 
-    /* register interest in all led columns */
-    ovsdb_idl_add_table(idl, &ovsrec_table_led);
-    ovsdb_idl_add_column(idl, &ovsrec_led_col_id);
-    ovsdb_idl_omit_alert(idl, &ovsrec_led_col_id);
-    ovsdb_idl_add_column(idl, &ovsrec_led_col_state);
-    ovsdb_idl_add_column(idl, &ovsrec_led_col_status);
-    ovsdb_idl_omit_alert(idl, &ovsrec_led_col_status);
+    SHASH_FOR_EACH_SAFE(node, next, &subsys->patterns) {
+        ledd_pattern_destroy(node->data);
+        shash_delete(&subsys->patterns, node);
+    }
 
-    /* register interest in the subsystems. this process needs the
-       name and hw_desc_dir fields. the name value must be unique within
-       all subsystems (used as a key). the hw_desc_dir needs to be populated
-       with the location where the hardware description files are located */
-    ovsdb_idl_add_table(idl, &ovsrec_table_subsystem);
-    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_other_config);
-    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_name);
-    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_hw_desc_dir);
-    ovsdb_idl_add_column(idl, &ovsrec_subsystem_col_leds);
-    ovsdb_idl_omit_alert(idl, &ovsrec_subsystem_col_leds);
+    SMAP_FOR_EACH(cnode, &subsys->pattern_config) {
+        const char *name = cnode->key + strlen(LEDD_PATTERN_KEY_PREFIX);
+        struct ledd_pattern *pattern;
+        char *error;
 
-    unixctl_command_register("ops-ledd/dump", "", 0, 0,
-                             ledd_unixctl_dump, NULL);
+        if (strncmp(cnode->key, LEDD_PATTERN_KEY_PREFIX,
+                    strlen(LEDD_PATTERN_KEY_PREFIX))) {
+            continue;
+        }
+
+        pattern = ledd_pattern_parse(name, cnode->value, &error);
+        if (pattern == NULL) {
+            VLOG_WARN_RL(&rl, "subsystem %s: LED pattern %s: %s",
+                         subsys->name, name, error);
+            free(error);
+            continue;
+        }
+        ledd_pattern_destroy(shash_replace(&subsys->patterns, name, pattern));
+    }
+
+    SMAP_FOR_EACH(cnode, &subsys->pattern_config) {
+        const char *name = cnode->key + strlen(LEDD_LED_KEY_PREFIX);
+        struct locl_led *led;
+
+        if (strncmp(cnode->key, LEDD_LED_KEY_PREFIX,
+                    strlen(LEDD_LED_KEY_PREFIX))) {
+            continue;
+        }
+
+        led = shash_find_data(&subsys->subsystem_leds, name);
+        if (led == NULL) {
+            VLOG_WARN_RL(&rl, "subsystem %s: no LED %s for pattern %s",
+                         subsys->name, name, cnode->value);
+            continue;
+        }
+
+        led->pattern = shash_find_data(&subsys->patterns, cnode->value);
+        if (led->pattern == NULL) {
+            led->pattern = ledd_pattern_builtin(cnode->value);
+        }
+        if (led->pattern == NULL) {
+            VLOG_WARN_RL(&rl, "subsystem %s: unknown pattern %s for LED %s",
+                         subsys->name, cnode->value, name);
+        }
+    }
+
+    SHASH_FOR_EACH(node, &subsys->subsystem_leds) {
+        struct locl_led *led = node->data;
+
+        if (led->state == LED_STATE_FLASHING && !ledd_write_led(subsys, led)) {
+            led->status = LED_STATUS_FAULT;
+            ledd_mark_status_dirty(led);
+        }
+    }
+} /* ledd_update_patterns() */
+
+/* index of the first bring-up LED of a subsystem, from first on, whose
+   first write is not done yet: an LED is only published once its status
+   comes from a completed write. An LED still in the write batch or in a
+   bus job is not done. */
+static size_t
+ledd_bringup_done(const struct locl_subsystem *lsubsys, size_t first)
+{
+    size_t n = first;
+
+    while (n < lsubsys->n_written
+           && list_is_empty(&lsubsys->bringup[n]->write_node)) {
+        n++;
+    }
+
+    return(n);
+} /* ledd_bringup_done() */
+
+/* first bring-up LED of a subsystem not published, nor in commit_txn */
+static size_t
+ledd_publish_first(const struct locl_subsystem *lsubsys)
+{
+    return(lsubsys->publish_inflight
+           ? lsubsys->n_publishing : lsubsys->n_published);
+} /* ledd_publish_first() */
+
+/************************************************************************//**
+ * Function that adds the next LEDs of a subsystem, in bring-up order, into
+ *     the ovsdb led table and links them to the subsystem, as part of
+ *     commit_txn. It may be called more than once for the same transaction.
+ *
+ * Logic:
+ *      - publish the LEDs after the ones already published (or already in
+ *          commit_txn), whose first write is done, up to limit and at most
+ *          budget of them
+ *      - foreach led in the subsystem, up to the last one published
+ *          - find its led row, or add one to the LED table
+ *          - set the LED status, if it is newly published
+ *      - set subsystem:leds
+ *
+ * Each call rewrites subsystem:leds with all the LEDs published so far,
+ * since LED rows are only kept by the db while a subsystem refers to them.
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+ledd_publish_subsystem(struct locl_subsystem *lsubsys, size_t limit,
+                       size_t *budget)
+{
+    const struct ovsrec_subsystem *ovsrec_subsys;
+    struct ovsrec_led **led_array;
+    size_t first, end;
+    size_t idx;
+
+    first = ledd_publish_first(lsubsys);
+    end = MIN(limit, first + MIN(*budget, lsubsys->n_bringup - first));
+    end = MIN(end, ledd_bringup_done(lsubsys, first));
+    if (end <= first) {
+        return;
+    }
+
+    ovsrec_subsys = ovsrec_subsystem_get_for_uuid(idl, &lsubsys->ovs_uuid);
+    if (ovsrec_subsys == NULL) {
+        /* The subsystem is gone, it will be removed on the next pass. */
+        lsubsys->publish_pending = false;
+        return;
+    }
+
+    led_array = (struct ovsrec_led **) xcalloc(end, sizeof *led_array);
+
+    for (idx = 0; idx < end; idx++) {
+        struct locl_led *led = lsubsys->bringup[idx];
+        const struct ovsrec_led *ovs_led;
+
+        /* look for existing LED rows */
+        ovs_led = ovsrec_led_get_for_uuid(idl, &led->row_uuid);
+        if (ovs_led == NULL) {
+            ovs_led = lookup_led(led->name);
+        }
+
+        /* If it isn't in ovsdb, then add it. */
+        if (ovs_led == NULL) {
+            struct ovsrec_led *new_row = ovsrec_led_insert(commit_txn);
+
+            ovsrec_led_set_id(new_row, led->name);
+            ovsrec_led_set_state(new_row, ledd_state_to_string(led->state));
+            ovs_led = new_row;
+            ledd_row_index_add(&led_rows, new_row);
+        }
+
+        /* The status is written here, not through the dirty list. */
+        if (idx >= first) {
+            ovsrec_led_set_status(ovs_led,
+                                  ledd_status_to_string(led->status));
+            list_remove(&led->status_node);
+            list_init(&led->status_node);
+        }
+
+        led_array[idx] = CONST_CAST(struct ovsrec_led *, ovs_led);
+    }
+
+    /* Push the data to the DB. */
+    ovsrec_subsystem_set_leds(ovsrec_subsys, led_array, end);
+
+    free(led_array);
+
+    *budget -= end - first;
+    lsubsys->n_publishing = end;
+    lsubsys->publish_inflight = true;
+} /* ledd_publish_subsystem() */
+
+static const struct ovsrec_daemon *
+ledd_find_daemon(const char *name)
+{
+    const struct ovsrec_daemon *ovs_daemon;
+
+    OVSREC_DAEMON_FOR_EACH(ovs_daemon, idl) {
+        if (!strcmp(ovs_daemon->name, name)) {
+            return(ovs_daemon);
+        }
+    }
 
-    retval = event_log_init("LED");
+    return(NULL);
+} /* ledd_find_daemon() */
 
-    if(retval < 0) {
-         VLOG_ERR("Event log initialization failed for LED");
+/* number of the shards given with --shards that have reported themselves
+   ready in the db. Rows of other shards, or of shards that exited, do not
+   count. */
+static int
+ledd_count_ready_shards(void)
+{
+    const struct ovsrec_daemon *ovs_daemon;
+    size_t len = strlen(NAME_IN_DAEMON_TABLE);
+    int n = 0;
+
+    OVSREC_DAEMON_FOR_EACH(ovs_daemon, idl) {
+        if (!strncmp(ovs_daemon->name, NAME_IN_DAEMON_TABLE, len)
+            && ovs_daemon->name[len] == LEDD_SHARD_DAEMON_SEP
+            && sset_contains(&all_shards, ovs_daemon->name + len + 1)
+            && ovs_daemon->cur_hw == 1) {
+            n++;
+        }
     }
-} /* ledd_init() */
 
-struct ovsrec_led *
-lookup_led(const char *name)
+    return(n);
+} /* ledd_count_ready_shards() */
+
+/* true once this process has applied the db, and every subsystem it owns
+   (all of them, without a shard) is loaded (or failed to) and published */
+static bool
+ledd_shard_ready(void)
 {
-    const struct ovsrec_led *led;
+    struct shash_node *node;
+
+    if (last_apply_time == 0) {
+        return(false);
+    }
+
+    SHASH_FOR_EACH(node, &subsystem_data) {
+        const struct locl_subsystem *subsystem = node->data;
 
-    OVSREC_LED_FOR_EACH(led, idl) {
-        if (strcmp(led->id, name) == 0) {
-            return((struct ovsrec_led *)led);
+        if (subsystem->subsys_status == LEDD_SUBSYS_STATUS_LOADING
+            || subsystem->publish_pending || subsystem->publish_inflight) {
+            return(false);
         }
     }
 
-    return(NULL);
-} /* lookup_led() */
+    return(true);
+} /* ledd_shard_ready() */
 
 /************************************************************************//**
- * Function that looks to see if the user has
- *     changed the desired state of any LED and then processes the request
+ * Function that handles the outcome of commit_txn.
  *
  * Logic:
- *   foreach LED in this subsystem
- *       find the matching entry in the LED table in ovsdb
- *       if the state has changed   (User requested a state change)
- *           set the LED to the new state
- *           update the LED status in ovsdb, if changed
+ *     - on anything but success, requeue the contents of the transaction
+ *          (subsystem publications and LED statuses) from local state, so
+ *          the next transaction carries them without a rescan of the db
+ *     - on TRY_AGAIN, retry once the db changes; on a hard failure, retry
+ *          once the db changes and a backoff, doubled on each failure in a
+ *          row, has passed
+ *     - on success, mark cur_hw as written
+ *     - destroy the transaction
  *
  * Returns:  void
  ***************************************************************************/
-void
-process_changes_in_subsys(struct locl_subsystem *subsys)
+static void
+ledd_commit_done(enum ovsdb_idl_txn_status status)
 {
-    const struct ovsrec_led *ovs_led;
-    struct locl_led *led;
     struct shash_node *node;
+    struct locl_led *led;
+    bool retry = (status != TXN_SUCCESS && status != TXN_UNCHANGED);
 
-    /* If we were unable to process the hwdesc file for this subsys, return. */
-    if (subsys->subsys_status == LEDD_SUBSYS_STATUS_IGNORE) {
-        VLOG_DBG("subsys %s set to IGNORE",subsys->name);
-        return;
+    COVERAGE_INC(ledd_txn_commit);
+
+    if (status == TXN_TRY_AGAIN) {
+        COVERAGE_INC(ledd_txn_try_again);
+        commit_retry_wait = true;
+        commit_retry_seqno = ovsdb_idl_get_seqno(idl);
+    } else if (retry && status != TXN_NOT_LOCKED) {
+        static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 5);
+
+        COVERAGE_INC(ledd_txn_failed);
+        if (commit_backoff == 0) {
+            commit_backoff = LEDD_TXN_BACKOFF_MIN_MS;
+        }
+        VLOG_WARN_RL(&rl, "ovsdb transaction failed: %s (%s), retrying in "
+                     "%d ms", ovsdb_idl_txn_status_to_string(status),
+                     ovsdb_idl_txn_get_error(commit_txn), commit_backoff);
+        commit_retry_wait = true;
+        commit_retry_seqno = ovsdb_idl_get_seqno(idl);
+        commit_retry_time = time_msec() + commit_backoff;
+        commit_backoff = MIN(commit_backoff * 2, LEDD_TXN_BACKOFF_MAX_MS);
+    } else if (!retry) {
+        commit_backoff = 0;
     }
 
-    /* foreach led in this subsystem... */
-    SHASH_FOR_EACH(node, &(subsys->subsystem_leds)) {
-        led = (struct locl_led *)node->data;
+    SHASH_FOR_EACH(node, &subsystem_data) {
+        struct locl_subsystem *subsystem = (struct locl_subsystem *)node->data;
 
-        /* foreach entry in the LED table */
-        OVSREC_LED_FOR_EACH(ovs_led, idl) {
-            /* If they don't match, continue. */
-            if (strcmp(led->name, ovs_led->id) != 0) {
-                continue;
+        if (subsystem->publish_inflight) {
+            subsystem->publish_inflight = false;
+            if (status == TXN_SUCCESS || status == TXN_UNCHANGED) {
+                subsystem->n_published = subsystem->n_publishing;
+                subsystem->publish_pending =
+                    subsystem->n_published < subsystem->n_bringup;
+                if (!subsystem->publish_pending) {
+                    subsystem->load_times.published = time_usec();
+                    /* cur_hw may be due, with nothing else to wake us */
+                    poll_immediate_wake();
+                }
+            } else {
+                subsystem->publish_pending = true;
             }
+        }
+    }
 
-            /* If a new state has been written into the db, process it. */
-            if (led->state != ledd_state_to_enum(ovs_led->state)) {
-                enum ovsrec_led_status_e status;
+    LIST_FOR_EACH_POP(led, status_node, &commit_leds) {
+        if (retry) {
+            list_push_back(&dirty_leds, &led->status_node);
+        } else {
+            list_init(&led->status_node);
+            ledd_record_committed(led);
+        }
+    }
 
-                led->state = ledd_state_to_enum(ovs_led->state);
+    if (cur_hw_inflight) {
+        cur_hw_inflight = false;
+        cur_hw_set = (status == TXN_SUCCESS || status == TXN_UNCHANGED);
+    }
+    if (shard_ready_inflight) {
+        shard_ready_inflight = false;
+        shard_ready_set = (status == TXN_SUCCESS || status == TXN_UNCHANGED);
+    }
 
-                /* If we have a valid type, write to the LED */
-                if (ledd_get_led_type(subsys, led->yaml_led->type) !=
-                                        (YamlLedType *) NULL) {
+    ovsdb_idl_txn_destroy(commit_txn);
+    commit_txn = NULL;
+} /* ledd_commit_done() */
 
-                    if (ledd_write_led(subsys, led)) {
-                        VLOG_DBG("ledd_write successful, %s",led->name);
-                        status = LED_STATUS_OK;
-                    } else {
-                        VLOG_WARN("ledd_write failed, %s",led->name);
-                        status = LED_STATUS_FAULT;
-                    }
-                } else {
-                    VLOG_WARN("Unable to write LED %s, led type %s unknown",
-                            led->name, led->yaml_led->type);
-                    status = LED_STATUS_FAULT;
-                }
+/* complete commit_txn, if it is in flight and the result is in */
+static void
+ledd_commit_run(void)
+{
+    enum ovsdb_idl_txn_status status;
 
-                /* If there is a new status, push it to the db. */
-                if (ledd_status_to_enum(ovs_led->status) != status) {
-                    ovsrec_led_set_status(ovs_led,
-                         ledd_status_to_string(status));
-                    change_to_commit = true;
-                }
-            }
-        }
-        subsys->marked = true;
+    if (commit_txn == NULL) {
+        return;
     }
 
-} /* process_changes_in_subsys() */
+    status = ovsdb_idl_txn_commit(commit_txn);
+    if (status != TXN_INCOMPLETE) {
+        ledd_commit_done(status);
+    }
+} /* ledd_commit_run() */
 
 /************************************************************************//**
- * Function that creates a new locl_subsystem structure
- *     when a new subsystem is found in ovsdb, sets the LEDs to their
- *     default values, and adds the LEDs into the ovsdb led table.
+ * Function that starts a transaction for any pending changes, if no
+ *     transaction is in flight. It does not wait for the result; that is
+ *     picked up by ledd_commit_run() on a later pass through the main loop.
  *
  * Logic:
- *      - create a new locl_subsystem structure, add to hash
- *      - tag the subsystem as "unmarked" and as IGNORE
- *      - extract the LED information for this subsys from the hw desc files.
- *        This includes names and types of LEDs, and their supported
- *        states and settings.
- *      - foreach valid led
- *          - write the default value to the LED
- *          - add the LED to the LED table (add to transaction)
- *      - tag the subsystem as "marked" and as OK
- *      - set change_to_commit = true  (transaction has changes to be pushed)
+ *     - publish the LED rows of new subsystems, at most bringup_chunk of
+ *          them: the loc LEDs of every subsystem, then the other LEDs
+ *     - write the status of each LED on the dirty list; an LED whose row
+ *          is not in the db yet waits for the next db changes
+ *     - with a shard, once it is ready, set cur_hw in its own daemon row,
+ *          and clear it until then
+ *     - once every subsystem is set up and published (with shards, once
+ *          all of them have their daemon row), set cur_hw = 1
+ *     - submit the transaction
  *
  * Returns:  void
  ***************************************************************************/
-void
-add_subsystem(const struct ovsrec_subsystem *ovsrec_subsys,
-                            struct ovsdb_idl_txn *txn)
+static void
+ledd_commit_start(void)
 {
-    struct locl_subsystem *lsubsys;
-    int rc;
-    int type_count;
-    int idx;
-    int led_count;
-    struct ovsrec_led **led_array;
-    const char *dir;
-    const YamlLedInfo *led_info;
-
-    VLOG_DBG("Adding new subsystem %s", ovsrec_subsys->name);
-
-    lsubsys = (struct locl_subsystem *)malloc(sizeof(struct locl_subsystem));
-    memset(lsubsys, 0, sizeof(struct locl_subsystem));
-
-    (void)shash_add(&subsystem_data, ovsrec_subsys->name, (void *)lsubsys);
-
-    lsubsys->name = strdup(ovsrec_subsys->name);
-    lsubsys->marked = false;
-    lsubsys->subsys_status = LEDD_SUBSYS_STATUS_IGNORE;
-    lsubsys->parent_subsystem = NULL;  /* OPS_TODO: find parent subsystem */
-
-    shash_init(&lsubsys->subsystem_leds);
-    shash_init(&lsubsys->subsystem_types);
-
-    /* use a default if the hw_desc_dir has not been populated */
-    dir = ovsrec_subsys->hw_desc_dir;
+    const struct ovsrec_daemon *ovs_daemon = NULL;
+    struct shash_node *node;
+    struct locl_led *led;
+    bool publish = false;
+    bool shard_ready = false;
+    bool shard_stale = false;
+    size_t budget;
+    int round;
 
-    if (dir == NULL || strlen(dir) == 0) {
-        VLOG_ERR("No h/w description directory for subsystem %s",
-                                    ovsrec_subsys->name);
+    if (commit_txn != NULL) {
         return;
     }
 
-    /* since this is a new subsystem, load all of the hardware description
-       information about the LEDs (just for this subsystem).
-       parse LED and device data for subsystem */
-    rc = yaml_add_subsystem(yaml_handle, ovsrec_subsys->name, dir);
-
-    if (rc != 0) {
-        VLOG_ERR("Error processing h/w description files for subsystem %s",
-                                    ovsrec_subsys->name);
-        return;
+    /* After a failure, wait for the db contents to change, and for the
+       backoff after a hard failure to pass, before retrying. */
+    if (commit_retry_wait) {
+        if (commit_retry_seqno == ovsdb_idl_get_seqno(idl)
+            || time_msec() < commit_retry_time) {
+            return;
+        }
+        commit_retry_wait = false;
     }
 
-    rc = yaml_parse_devices(yaml_handle, ovsrec_subsys->name);
+    SHASH_FOR_EACH(node, &subsystem_data) {
+        struct locl_subsystem *subsystem = (struct locl_subsystem *)node->data;
 
-    if (rc != 0) {
-        VLOG_ERR("Unable to parse subsystem %s devices file (in %s)",
-                                ovsrec_subsys->name, dir);
-        return;
+        /* LEDs still being written are published on a later pass */
+        if (subsystem->publish_pending
+            && ledd_bringup_done(subsystem, ledd_publish_first(subsystem))
+               > ledd_publish_first(subsystem)) {
+            publish = true;
+            break;
+        }
     }
 
-    rc = yaml_parse_leds(yaml_handle, ovsrec_subsys->name);
+    if (shard_daemon_name != NULL && !shard_ready_set) {
+        const struct ovsrec_daemon *shard_daemon;
 
-    if (rc != 0) {
-        VLOG_ERR("Unable to parse subsystem %s led file (in %s)",
-                                ovsrec_subsys->name, dir);
-        return;
+        /* a row left set by an earlier run does not count for this one */
+        shard_ready = ledd_shard_ready();
+        shard_daemon = ledd_find_daemon(shard_daemon_name);
+        shard_stale = (!shard_ready && shard_daemon != NULL
+                       && shard_daemon->cur_hw != 0);
     }
 
-    led_info = yaml_get_led_info(yaml_handle, ovsrec_subsys->name);
+    /* cur_hw tells the platform the LEDs are up: wait for every subsystem
+       to be set up and its LED rows published. */
+    if (!cur_hw_set
+        && (shard_daemon_name == NULL
+            ? ledd_shard_ready()
+            : shard_ready_set
+              && ledd_count_ready_shards() == sset_count(&all_shards))) {
+        ovs_daemon = ledd_find_daemon(NAME_IN_DAEMON_TABLE);
+    }
 
-    if (led_info == NULL) {
-        VLOG_INFO("subsystem %s has no LED info", ovsrec_subsys->name);
+    if (!publish && list_is_empty(&dirty_leds) && ovs_daemon == NULL
+        && !shard_ready && !shard_stale) {
         return;
     }
 
-    /* get the # of LED types */
-    lsubsys->num_types =
-        yaml_get_led_type_count(yaml_handle, ovsrec_subsys->name);
-    type_count = led_info->number_types;
+    commit_txn = ovsdb_idl_txn_create(idl);
 
-    /* get the # of LEDs found in the yaml file. */
-    lsubsys->num_leds = yaml_get_led_count(yaml_handle, ovsrec_subsys->name);
-    led_count = led_info->number_leds;
-
-    if ( (lsubsys->num_leds <= 0) || (lsubsys->num_types <= 0) ) {
-        return;
-    }
+    budget = bringup_chunk > 0 ? bringup_chunk : SIZE_MAX;
+    for (round = 0; round < 2 && publish; round++) {
+        SHASH_FOR_EACH(node, &subsystem_data) {
+            struct locl_subsystem *subsystem = node->data;
 
-    /* Verify that the type # specified and # found are the same. */
-    if (lsubsys->num_types != type_count) {
-        VLOG_WARN("LED type count does not match in %s/led.yaml file. Info "
-                "says it is %d, while the number counted in the file is %d",
-                dir, type_count, lsubsys->num_types);
-        type_count = lsubsys->num_types;
-    }
-    else {
-        VLOG_DBG("There are %d LED types in subsystem %s", type_count,
-                                 ovsrec_subsys->name);
-        log_event("LED_COUNT", EV_KV("count", "%d", type_count),
-            EV_KV("subsystem", "%s", ovsrec_subsys->name));
+            if (subsystem->publish_pending) {
+                ledd_publish_subsystem(subsystem,
+                                       round == 0 ? subsystem->n_loc
+                                                  : subsystem->n_bringup,
+                                       &budget);
+            }
+        }
     }
+    SHASH_FOR_EACH(node, &subsystem_data) {
+        struct locl_subsystem *subsystem = (struct locl_subsystem *)node->data;
 
-    /* Verify that the LED # specified and # found are the same. */
-    if (lsubsys->num_leds != led_count) {
-        VLOG_WARN("LED count does not match in %s/led.yaml file. Info says "
-                "it is %d, while the number counted in the file is %d",
-                dir, led_count, lsubsys->num_leds);
-        led_count = lsubsys->num_leds;
-    }
-    else {
-        VLOG_DBG("There are %d LEDs in subsystem %s", led_count,
-                                 ovsrec_subsys->name);
+        if (subsystem->publish_inflight) {
+            subsystem->publish_pending = false;
+        }
     }
 
-    led_array = (struct ovsrec_led **)
-                xcalloc(led_count, sizeof(struct ovsrec_led *));
-
-    /* Add the types to the locl_subsystem structure */
-    for (idx = 0; idx < (int) type_count; idx++) {
-        size_t i;
-        bool found = false;
-        const YamlLedType *new_type;
-
-        new_type = yaml_get_led_type(yaml_handle, ovsrec_subsys->name, idx);
-
-        if (new_type == (YamlLedType *) NULL) {
-            VLOG_ERR("subsystem %s had error reading LED type",
-                     ovsrec_subsys->name);
-            continue;
-        }
+    LIST_FOR_EACH_POP(led, status_node, &dirty_leds) {
+        const struct ovsrec_led *ovs_led;
 
-        /* See if this is a type we know about. */
-        for (i = 0; i < sizeof(led_type_strings)/sizeof(const char *);
-                                                i++) {
-            if (strcmp(led_type_strings[i], new_type->type) == 0) {
-                found = true;
-                break;
+        /* The row of a just published LED is learned when its change is
+           applied, which coalescing may hold; look it up by id. */
+        ovs_led = ovsrec_led_get_for_uuid(idl, &led->row_uuid);
+        if (ovs_led == NULL) {
+            ovs_led = lookup_led(led->name);
+            if (ovs_led != NULL) {
+                led->row_uuid = ovs_led->header_.uuid;
             }
         }
 
-        /* If we know about it, add it. */
-        if (found) {
-            shash_add(&(lsubsys->subsystem_types), new_type->type,
-                                    (void *)new_type);
+        if (ovs_led == NULL) {
+            /* retried once the next db changes are applied */
+            list_push_back(&rowless_leds, &led->status_node);
+        } else if (ledd_status_to_enum(ovs_led->status) != led->status) {
+            ovsrec_led_set_status(ovs_led, ledd_status_to_string(led->status));
+            list_push_back(&commit_leds, &led->status_node);
         } else {
-            VLOG_DBG("unknown type %s specified in %s", new_type->type, dir);
+            /* the db already has this status */
+            list_init(&led->status_node);
+            ledd_record_committed(led);
         }
     }
 
-    /* walk through LEDs and add them to DB */
-    for (idx = 0; idx < led_count; idx++) {
-        struct ovsrec_led *ovs_led;
-        char *led_name = NULL;
-        const YamlLed *led;
-        struct locl_led *new_led;
-        YamlLedType *led_type;
-
-        led = yaml_get_led(yaml_handle, ovsrec_subsys->name, idx);
+    /* Report this shard ready. A restarted shard finds its row there. */
+    if (shard_ready) {
+        const struct ovsrec_daemon *shard_daemon;
 
-        VLOG_DBG("Adding LED %s in subsystem %s", led->name,
-                                        ovsrec_subsys->name);
+        shard_daemon = ledd_find_daemon(shard_daemon_name);
+        if (shard_daemon == NULL) {
+            shard_daemon = ovsrec_daemon_insert(commit_txn);
+            ovsrec_daemon_set_name(shard_daemon, shard_daemon_name);
+        }
+        ovsrec_daemon_set_cur_hw(shard_daemon, (int64_t) 1);
+        shard_ready_inflight = true;
+    } else if (shard_stale) {
+        ovsrec_daemon_set_cur_hw(ledd_find_daemon(shard_daemon_name),
+                                 (int64_t) 0);
+    }
 
-        /* Create the new locl led struct and initialize it. */
-        asprintf(&led_name, "%s-%s", ovsrec_subsys->name, led->name);
-        new_led = (struct locl_led *)malloc(sizeof(struct locl_led));
-        new_led->name = led_name;
-        new_led->subsystem = lsubsys;
-        new_led->yaml_led = led;
-        new_led->state = LED_STATE_OFF;
-        new_led->status = LED_STATUS_OK;
+    /* Set cur_hw = 1, once the LEDs are up. */
+    if (ovs_daemon != NULL) {
+        ovsrec_daemon_set_cur_hw(ovs_daemon, (int64_t) 1);
+        cur_hw_inflight = true;
+    }
 
-        led_type = ledd_get_led_type(lsubsys, led->type);
-        if (led_type == NULL) {
-            new_led->settings = (YamlLedTypeSettings *)NULL;
-            new_led->status = LED_STATUS_FAULT;
-        } else {
-            new_led->settings = &(led_type->settings);
-        }
+    ledd_commit_run();
+} /* ledd_commit_start() */
 
-        /* Add this new locl led to the led shash in subsystem shash */
-        shash_add(&lsubsys->subsystem_leds, led->name, (void *)new_led);
+/************************************************************************//**
+ * Function that sets up the subsystems whose hardware description files
+ *     the loader threads are done with.
+ *
+ * Returns: True if any subsystem was set up, else False
+ ***************************************************************************/
+static bool
+ledd_finish_loads(void)
+{
+    struct locl_subsystem *lsubsys;
+    struct ledd_load *load;
+    bool any = false;
 
-        /* look for existing LED rows */
-        ovs_led = lookup_led(led_name);
+    while ((load = ledd_load_poll()) != NULL) {
+        lsubsys = shash_find_data(&subsystem_data, load->name);
+        ovs_assert(lsubsys != NULL);
 
-        /* If it isn't in ovsdb, then add it. */
-        if (ovs_led == NULL) {
-            ovs_led = ovsrec_led_insert(txn);
+        ledd_prof_wakeup(LEDD_WAKEUP_WORKER);
+        ledd_finish_subsystem(lsubsys, load);
+        ledd_load_destroy(load);
+        any = true;
+    }
 
-            /* Add to ovsdb. */
-            ovsrec_led_set_id(ovs_led, led_name);
-            ovsrec_led_set_state(ovs_led,
-                    ledd_state_to_string(new_led->state));
-        }
+    return(any);
+} /* ledd_finish_loads() */
 
-        /* Write the LED */
-        if (ledd_write_led(lsubsys, new_led)) {
-            VLOG_DBG("ledd_write successful, %s",led->name);
-            new_led->status = LED_STATUS_OK;
-        } else {
-            VLOG_WARN("ledd_write failed, %s",led->name);
-            new_led->status = LED_STATUS_FAULT;
-        }
+/* coalescing window and latency cap in effect, in ms: the largest ones
+   set in the other_config of any subsystem when the subsystems were last
+   processed, else the command line ones */
+static void
+ledd_coalesce_config(int *window, int *max)
+{
+    *window = db_coalesce_window >= 0 ? db_coalesce_window : coalesce_window;
+    *max = db_coalesce_max >= 0 ? db_coalesce_max : coalesce_max;
+} /* ledd_coalesce_config() */
 
-        /* Either way, set that status accordingly. */
-        ovsrec_led_set_status(ovs_led,
-                    ledd_status_to_string(new_led->status));
+/************************************************************************//**
+ * Function that decides whether the db changes seen by this pass are held,
+ *     to be applied together with the ones that follow them.
+ *
+ * Logic:
+ *     - a change that comes more than the window after the last changes
+ *       were applied is applied right away, so a single change is never
+ *       delayed
+ *     - else it opens (or extends) a window, and it is held until the
+ *       window passes with no new change, or until the first held change
+ *       has waited for the latency cap
+ *
+ * Returns: True if the changes are held, else False
+ ***************************************************************************/
+static bool
+ledd_coalesce_hold(unsigned int new_idl_seqno)
+{
+    long long int now = time_msec();
+    int window, max;
 
-        led_array[idx] = ovs_led;
+    ledd_coalesce_config(&window, &max);
+    if (window <= 0) {
+        coalesce_start = 0;
+        return(false);
     }
 
-    /* Push the data to the DB. */
-    ovsrec_subsystem_set_leds(ovsrec_subsys, led_array, led_count);
-    change_to_commit = true;
-
-    free(led_array);
+    if (coalesce_start == 0) {
+        if (now - last_apply_time >= window) {
+            return(false);
+        }
+        coalesce_start = now;
+        coalesce_last = now;
+        coalesce_seqno = new_idl_seqno;
+    } else if (new_idl_seqno != coalesce_seqno) {
+        coalesce_last = now;
+        coalesce_seqno = new_idl_seqno;
+    }
 
-    /* Update the state of the locl_subsystem structure */
-    lsubsys->marked = true;
-    lsubsys->subsys_status = LEDD_SUBSYS_STATUS_OK;
+    coalesce_deadline = MIN(coalesce_last + window, coalesce_start + max);
+    if (now < coalesce_deadline) {
+        COVERAGE_INC(ledd_coalesced);
+        return(true);
+    }
 
-    return;
-} /* add_subsystem() */
+    coalesce_start = 0;
+    return(false);
+} /* ledd_coalesce_hold() */
 
 /************************************************************************//**
  * Function that looks for changes in the OVSDB that need
@@ -855,109 +2838,321 @@ add_subsystem(const struct ovsrec_subsystem *ovsrec_subsys,
  *     configuration data.
  *
  * Logic:
- *     - initialize empty transaction
+ *     - set up the subsystems whose hw description files were loaded
+ *     - hold the db changes while a burst of them is coming in, so they
+ *          are applied in one pass, one write batch and one commit
  *     - unmark all subsystems so removed subsystems can be detected.
- *     - foreach subsystem in ovsdb
- *        - if new_to_us, call add_subsystem
- *        - else call process_changes_in_subsys
- *     - if first_time_through_loop, set cur_hw_cfg = 1
- *     - if change_to_commit is true, submit the transaction
+ *     - note the coalescing settings in the other_config of every
+ *          subsystem, for the next passes
+ *     - foreach subsystem in ovsdb that belongs to our shard
+ *        - if new_to_us, call add_subsystem to start loading it
+ *        - else mark it as still present
+ *        - apply its LED pattern configuration
+ *     - if the lock was just acquired, apply every LED row, else apply
+ *          only the changed LED rows
  *     - call ledd_remove_unmarked_subsystems to process (delete)
  *          any subsystems no longer in ovsdb
  *
  * Returns:  void
  ***************************************************************************/
 static void
-ledd_reconfigure(void)
+ledd_reconfigure(bool resync)
 {
     const struct ovsrec_subsystem *ovs_sub;
-    const struct ovsrec_daemon *ovs_daemon;
     unsigned int new_idl_seqno = ovsdb_idl_get_seqno(idl);
-    struct ovsdb_idl_txn *txn;
+    int window = -1, max = -1;
+    bool loaded;
 
     COVERAGE_INC(ledd_reconfigure);
 
-    if (new_idl_seqno == idl_seqno){
+    /* Set up the subsystems whose files were loaded since the last pass.
+       Their LEDs start in the state of their rows. */
+    loaded = ledd_finish_loads();
+
+    if (new_idl_seqno == idl_seqno && !resync && !loaded) {
+        return;
+    }
+
+    /* The IDL keeps tracking the changes while they are held. */
+    if (!resync && !loaded && ledd_coalesce_hold(new_idl_seqno)) {
         return;
     }
+    coalesce_start = 0;
+    last_apply_time = time_msec();
 
     /* Unmark all subsystems so we can tell if any have been removed. */
     ledd_unmark_subsystems();
 
-    change_to_commit = false;
-    txn = ovsdb_idl_txn_create(idl);
-
-    /* For each subsystem in ovsdb, process it (add or update) */
+    /* For each subsystem of this shard in ovsdb, process it (add or
+       update). The LED rows of other shards find no LED here, and are
+       left alone. */
     OVSREC_SUBSYSTEM_FOR_EACH(ovs_sub, idl) {
         struct locl_subsystem *subsystem;
 
+        /* The coalescing settings of any subsystem apply, of any shard. */
+        window = MAX(window, smap_get_int(&ovs_sub->other_config,
+                                          LEDD_COALESCE_WINDOW_KEY, -1));
+        max = MAX(max, smap_get_int(&ovs_sub->other_config,
+                                    LEDD_COALESCE_MAX_KEY, -1));
+
+        if (!ledd_shard_owns(&shard, ovs_sub->name)) {
+            continue;
+        }
+
         subsystem = shash_find_data(&subsystem_data, ovs_sub->name);
 
         if (subsystem == NULL) {
-            /* If the subsystem is new, add it */
-            add_subsystem(ovs_sub, txn);
-        } else {
-            /* Else, look for any changes to process */
-            process_changes_in_subsys(subsystem);
+            /* If the subsystem is new, start loading it */
+            add_subsystem(ovs_sub);
+            subsystem = shash_find_data(&subsystem_data, ovs_sub->name);
+        } else if (subsystem->subsys_status != LEDD_SUBSYS_STATUS_IGNORE) {
+            /* Else, keep it. Subsystems we were unable to process are left
+               unmarked, so they are removed and retried on the next pass. */
+            subsystem->marked = true;
         }
-    }
-
-    idl_seqno = new_idl_seqno;
 
-    /* Set cur_hw = 1 if this is first time through. */
-    if (!cur_hw_set) {
-        OVSREC_DAEMON_FOR_EACH(ovs_daemon, idl) {
-            if (strncmp(ovs_daemon->name, NAME_IN_DAEMON_TABLE,
-                        strlen(NAME_IN_DAEMON_TABLE)) == 0) {
-                ovsrec_daemon_set_cur_hw(ovs_daemon, (int64_t) 1);
-                cur_hw_set = true;
-                change_to_commit = true;
-                break;
-            }
+        if (subsystem->subsys_status == LEDD_SUBSYS_STATUS_OK) {
+            ledd_update_patterns(subsystem, &ovs_sub->other_config);
         }
     }
 
-    /* If there are changes for ovsdb, submit the transaction. */
-    if (change_to_commit) {
-        ovsdb_idl_txn_commit_block(txn);
+    db_coalesce_window = window;
+    db_coalesce_max = max;
+
+    /* Apply any LED state changes written into the db. */
+    if (resync) {
+        process_all_led_rows();
+    } else {
+        process_tracked_led_changes();
     }
-    ovsdb_idl_txn_destroy(txn);
+    ovsdb_idl_track_clear(idl);
+
+    /* Their rows may have come in with these changes. */
+    list_push_back_all(&dirty_leds, &rowless_leds);
+
+    idl_seqno = new_idl_seqno;
 
     /* For any missing subsystems (no longer there), remove them. */
     ledd_remove_unmarked_subsystems();
 
 } /* ledd_reconfigure() */
 
+/************************************************************************//**
+ * Function that takes the LEDs over, when the lock is acquired.
+ *     Another process may have driven the LEDs until now, and a hot standby
+ *     has its LED changes waiting in the write batch.
+ *
+ * Logic:
+ *     - forget the values of the registers with no job in flight; they
+ *       are read again before they are next written
+ *     - read the LED class devices back, and write their LEDs
+ *
+ * The LED rows are applied in full by the reconfigure pass that follows,
+ * and the batch is flushed at the end of it.
+ *
+ * Returns:  void
+ ***************************************************************************/
+static void
+ledd_takeover(void)
+{
+    struct shash_node *snode, *lnode;
+    struct ledd_reg *reg;
+
+    SHASH_FOR_EACH(snode, &subsystem_data) {
+        struct locl_subsystem *subsystem = snode->data;
+
+        if (subsystem->subsys_status != LEDD_SUBSYS_STATUS_OK) {
+            continue;
+        }
+
+        HMAP_FOR_EACH(reg, node, &subsystem->led_regs) {
+            if (reg->n_inflight == 0) {
+                reg->valid = false;
+            }
+        }
+
+        SHASH_FOR_EACH(lnode, &subsystem->subsystem_leds) {
+            struct locl_led *led = lnode->data;
+
+            if (led->plan->sysfs != NULL) {
+                ledd_sysfs_refresh(led->plan->sysfs);
+                if (!ledd_write_led(subsystem, led)) {
+                    led->status = LED_STATUS_FAULT;
+                    ledd_mark_status_dirty(led);
+                }
+            }
+        }
+    }
+} /* ledd_takeover() */
+
 static void
 ledd_run(void)
 {
+    unsigned int seqno = ovsdb_idl_get_seqno(idl);
+    bool txn_inflight = (commit_txn != NULL);
+    bool resync;
+
+    ledd_prof_switch(LEDD_PHASE_IDL);
     ovsdb_idl_run(idl);
+    idl_run_time = time_usec();
+
+    /* Before anything clears the tracked changes. */
+    ledd_row_index_track(&led_rows, idl);
+
+    /* Pick up the result of any transaction or bus jobs in flight. */
+    ledd_prof_switch(LEDD_PHASE_COMMIT);
+    ledd_commit_run();
+    if (seqno != ovsdb_idl_get_seqno(idl) || (txn_inflight && !commit_txn)) {
+        ledd_prof_wakeup(LEDD_WAKEUP_IDL);
+    }
+    ledd_prof_switch(LEDD_PHASE_BUS);
+    ledd_reap_jobs();
+    ledd_prof_switch(LEDD_PHASE_OTHER);
 
     if (ovsdb_idl_is_lock_contended(idl)) {
         static struct vlog_rate_limit rl = VLOG_RATE_LIMIT_INIT(1, 1);
 
-        VLOG_ERR_RL(&rl, "another ops-ledd process is running, "
-                    "disabling this process until it goes away");
+        if (hot_standby) {
+            VLOG_INFO_RL(&rl, "another ops-ledd process is running, "
+                         "standing by until it goes away");
+        } else {
+            VLOG_ERR_RL(&rl, "another ops-ledd process is running, "
+                        "disabling this process until it goes away");
+        }
+    }
+
+    if (!ovsdb_idl_has_lock(idl)) {
+        have_lock = false;
+        if (!hot_standby) {
+            /* Changes are re-read in full once the lock is acquired. */
+            ovsdb_idl_track_clear(idl);
+            return;
+        }
 
-        return;
-    } else if (!ovsdb_idl_has_lock(idl)) {
+        /* Follow the db, without touching the hardware or the db. */
+        ledd_prof_switch(LEDD_PHASE_RECONFIGURE);
+        ledd_reconfigure(false);
+        ledd_bringup_run();
+        ledd_prof_switch(LEDD_PHASE_BUS);
+        ledd_blink_run();
+        ledd_prof_switch(LEDD_PHASE_OTHER);
+
+        daemonize_complete();
+        vlog_enable_async();
         return;
     }
 
-    ledd_reconfigure();
+    resync = !have_lock;
+    have_lock = true;
+
+    ledd_prof_switch(LEDD_PHASE_RECONFIGURE);
+    if (resync) {
+        ledd_takeover();
+    }
+    ledd_reconfigure(resync);
+    ledd_bringup_run();
+    ledd_prof_switch(LEDD_PHASE_BUS);
+    ledd_blink_run();
+
+    /* Write the LED registers changed by this pass, or left in the batch
+       by an earlier one because they were not read yet. */
+    ledd_flush_writes();
+
+    ledd_prof_switch(LEDD_PHASE_COMMIT);
+    ledd_commit_start();
+    ledd_prof_switch(LEDD_PHASE_OTHER);
+
+    if (resync) {
+        takeover_time = time_usec() - idl_run_time;
+        n_takeovers++;
+        VLOG_INFO("acquired the %s lock, took over the LEDs in %.1f ms",
+                  lock_name, takeover_time / 1000.0);
+    }
 
     daemonize_complete();
     vlog_enable_async();
     VLOG_INFO_ONCE("%s (OpenSwitch ledd) %s", program_name, VERSION);
 } /* ledd_run() */
 
+/* count the causes of a main loop wakeup in the coverage counters */
+static void
+ledd_count_wakeups(unsigned int causes)
+{
+    if (causes & (1u << LEDD_WAKEUP_IDL)) {
+        COVERAGE_INC(ledd_wakeup_idl);
+    }
+    if (causes & (1u << LEDD_WAKEUP_TIMER)) {
+        COVERAGE_INC(ledd_wakeup_timer);
+    }
+    if (causes & (1u << LEDD_WAKEUP_UNIXCTL)) {
+        COVERAGE_INC(ledd_wakeup_unixctl);
+    }
+    if (causes & (1u << LEDD_WAKEUP_WORKER)) {
+        COVERAGE_INC(ledd_wakeup_worker);
+    }
+    if (causes & (1u << LEDD_WAKEUP_OTHER)) {
+        COVERAGE_INC(ledd_wakeup_other);
+    }
+} /* ledd_count_wakeups() */
+
 static void
 ledd_wait(void)
 {
     ovsdb_idl_wait(idl);
+    ledd_load_wait();
+    ledd_io_wait();
+    ledd_wheel_wait(&blink_wheel);
+
+    if (coalesce_start != 0) {
+        poll_timer_wait_until(coalesce_deadline);
+    }
+
+    if (commit_txn != NULL) {
+        ovsdb_idl_txn_wait(commit_txn);
+    }
+
+    /* Retry a failed transaction once its backoff is over. */
+    if (commit_retry_wait && commit_retry_time > time_msec()) {
+        poll_timer_wait_until(commit_retry_time);
+    }
+
+    /* New subsystems have LEDs left to write. */
+    if (bringup_more) {
+        poll_immediate_wake();
+    }
 } /* ledd_wait() */
 
 /* ************ MAIN ******************** */
+/* clear the daemon row of this shard when it exits, so it no longer
+   counts as ready; a shard that dies leaves its row set until it is
+   started again */
+static void
+ledd_shard_exit(void)
+{
+    const struct ovsrec_daemon *shard_daemon;
+    struct ovsdb_idl_txn *txn;
+
+    if (shard_daemon_name == NULL || !have_lock) {
+        return;
+    }
+
+    if (commit_txn != NULL) {
+        (void)ovsdb_idl_txn_commit_block(commit_txn);
+        ovsdb_idl_txn_destroy(commit_txn);
+        commit_txn = NULL;
+    }
+
+    shard_daemon = ledd_find_daemon(shard_daemon_name);
+    if (shard_daemon != NULL && shard_daemon->cur_hw != 0) {
+        txn = ovsdb_idl_txn_create(idl);
+        ovsrec_daemon_set_cur_hw(shard_daemon, (int64_t) 0);
+        if (ovsdb_idl_txn_commit_block(txn) != TXN_SUCCESS) {
+            VLOG_WARN("unable to clear cur_hw of %s", shard_daemon_name);
+        }
+        ovsdb_idl_txn_destroy(txn);
+    }
+} /* ledd_shard_exit() */
+
 int
 main(int argc, char *argv[])
 {
@@ -989,16 +3184,22 @@ main(int argc, char *argv[])
     exiting = false;
     while (!exiting) {
         ledd_run();
+        ledd_prof_switch(LEDD_PHASE_UNIXCTL);
         unixctl_server_run(unixctl);
+        ledd_prof_switch(LEDD_PHASE_OTHER);
 
         ledd_wait();
         unixctl_server_wait(unixctl);
         if (exiting) {
             poll_immediate_wake();
         }
+        ledd_count_wakeups(ledd_prof_end_pass());
         poll_block();
+        ledd_prof_start_pass();
     }
 
+    ledd_shard_exit();
+    ledd_io_exit();
     ovsdb_idl_destroy(idl);
     unixctl_server_destroy(unixctl);
 
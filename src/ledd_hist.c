@@ -0,0 +1,167 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd latency histograms
+ *
+ ***************************************************************************/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "dynamic-string.h"
+#include "util.h"
+
+#include "ledd_hist.h"
+
+/* bucket of a value: the value itself below LEDD_HIST_SUB_BUCKETS, else
+   its power of two and its next LEDD_HIST_SUB_BITS bits */
+static size_t
+ledd_hist_bucket(uint64_t value)
+{
+    int shift;
+
+    if (value < LEDD_HIST_SUB_BUCKETS) {
+        return(value);
+    }
+    if (value >> LEDD_HIST_MAX_BITS) {
+        return(LEDD_HIST_BUCKETS - 1);
+    }
+
+    shift = (63 - raw_clz64(value)) - LEDD_HIST_SUB_BITS;
+    return((shift + 1) * LEDD_HIST_SUB_BUCKETS
+           + (value >> shift) - LEDD_HIST_SUB_BUCKETS);
+} /* ledd_hist_bucket() */
+
+/* middle of the range of values of a bucket */
+static uint64_t
+ledd_hist_bucket_value(size_t bucket)
+{
+    int shift;
+
+    if (bucket < LEDD_HIST_SUB_BUCKETS) {
+        return(bucket);
+    }
+
+    shift = bucket / LEDD_HIST_SUB_BUCKETS - 1;
+    return(((uint64_t)(bucket % LEDD_HIST_SUB_BUCKETS + LEDD_HIST_SUB_BUCKETS)
+            << shift) + ((1ULL << shift) >> 1));
+} /* ledd_hist_bucket_value() */
+
+void
+ledd_hist_record(struct ledd_hist *hist, uint64_t value)
+{
+    if (hist->counts == NULL) {
+        hist->counts = xcalloc(LEDD_HIST_BUCKETS, sizeof *hist->counts);
+    }
+
+    hist->counts[ledd_hist_bucket(value)]++;
+    if (hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+    hist->count++;
+    hist->sum += value;
+} /* ledd_hist_record() */
+
+/************************************************************************//**
+ * Function that finds the value below which pct percent of the recorded
+ *     values are.
+ *
+ * Returns: the value, within the precision of its bucket and never outside
+ *          the recorded min and max, or 0 if nothing was recorded
+ ***************************************************************************/
+uint64_t
+ledd_hist_percentile(const struct ledd_hist *hist, double pct)
+{
+    uint64_t rank, seen = 0;
+    size_t bucket;
+
+    if (hist->count == 0) {
+        return(0);
+    }
+
+    rank = (uint64_t)(pct / 100.0 * hist->count + 0.5);
+    rank = MAX(rank, 1);
+    for (bucket = 0; bucket < LEDD_HIST_BUCKETS; bucket++) {
+        seen += hist->counts[bucket];
+        if (seen >= rank) {
+            uint64_t value = ledd_hist_bucket_value(bucket);
+
+            if (bucket == LEDD_HIST_BUCKETS - 1) {
+                return(hist->max);      /* also holds larger values */
+            }
+
+            return(MIN(MAX(value, hist->min), hist->max));
+        }
+    }
+
+    return(hist->max);
+} /* ledd_hist_percentile() */
+
+void
+ledd_hist_merge(struct ledd_hist *dst, const struct ledd_hist *src)
+{
+    size_t bucket;
+
+    if (src->count == 0) {
+        return;
+    }
+
+    if (dst->counts == NULL) {
+        dst->counts = xcalloc(LEDD_HIST_BUCKETS, sizeof *dst->counts);
+    }
+    for (bucket = 0; bucket < LEDD_HIST_BUCKETS; bucket++) {
+        dst->counts[bucket] += src->counts[bucket];
+    }
+
+    if (dst->count == 0 || src->min < dst->min) {
+        dst->min = src->min;
+    }
+    dst->max = MAX(dst->max, src->max);
+    dst->count += src->count;
+    dst->sum += src->sum;
+} /* ledd_hist_merge() */
+
+/* forget all recorded values, and free the counters */
+void
+ledd_hist_reset(struct ledd_hist *hist)
+{
+    free(hist->counts);
+    memset(hist, 0, sizeof *hist);
+} /* ledd_hist_reset() */
+
+/* format count, min, mean, p50, p90, p99, p99.9 and max in columns */
+void
+ledd_hist_format(struct ds *ds, const struct ledd_hist *hist)
+{
+    static const double pcts[] = { 50, 90, 99, 99.9 };
+    size_t i;
+
+    ds_put_format(ds, "%8"PRIu64" %8"PRIu64" %8"PRIu64, hist->count,
+                  hist->min, hist->count ? hist->sum / hist->count : 0);
+    for (i = 0; i < ARRAY_SIZE(pcts); i++) {
+        ds_put_format(ds, " %8"PRIu64, ledd_hist_percentile(hist, pcts[i]));
+    }
+    ds_put_format(ds, " %8"PRIu64, hist->max);
+} /* ledd_hist_format() */
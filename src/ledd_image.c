@@ -0,0 +1,449 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd compiled LED description images
+ *
+ ***************************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include "config.h"
+#include "crc32c.h"
+#include "dynamic-string.h"
+#include "shash.h"
+#include "util.h"
+#include "openvswitch/vlog.h"
+
+#include "ledd_image.h"
+
+VLOG_DEFINE_THIS_MODULE(ledd_image);
+
+/* add a string to the string table being built, once; offset 0 is the
+   empty string, that starts the table */
+static uint32_t
+ledd_image_add_string(struct ds *strings, struct shash *offsets,
+                      const char *s)
+{
+    uint32_t offset;
+
+    if (s == NULL || s[0] == '\0') {
+        return(0);
+    }
+
+    offset = (uintptr_t)shash_find_data(offsets, s);
+    if (offset == 0) {
+        offset = strings->length;
+        ds_put_buffer(strings, s, strlen(s) + 1);
+        shash_add(offsets, s, (void *)(uintptr_t)offset);
+    }
+
+    return(offset);
+} /* ledd_image_add_string() */
+
+/************************************************************************//**
+ * Function that compiles the LED descriptions of a subsystem, from its
+ *     parsed led.yaml, into an image.
+ *
+ * Logic:
+ *     - index the LED types by name
+ *     - for each LED, record its name, type and register access, and the
+ *       settings of its type, flagging a missing type or access
+ *     - lay out the header, the LED records and the strings in a single
+ *       buffer, and checksum it
+ *
+ * Returns: the image, to be freed with ledd_image_close()
+ ***************************************************************************/
+struct ledd_image *
+ledd_image_compile(YamlConfigHandle handle, const char *subsystem,
+                   const uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    struct shash types = SHASH_INITIALIZER(&types);
+    struct shash offsets = SHASH_INITIALIZER(&offsets);
+    struct ds strings = DS_EMPTY_INITIALIZER;
+    const YamlLedInfo *info;
+    struct ledd_image_header *header;
+    struct ledd_image_led *leds;
+    struct ledd_image *image;
+    int n_types = 0;
+    int n_leds = 0;
+    size_t n = 0;
+    size_t size;
+    char *base;
+    int idx;
+
+    ds_put_char(&strings, '\0');
+
+    info = yaml_get_led_info(handle, subsystem);
+    if (info != NULL) {
+        n_types = MAX(yaml_get_led_type_count(handle, subsystem), 0);
+        n_leds = MAX(yaml_get_led_count(handle, subsystem), 0);
+
+        /* Verify that the counts specified and found are the same. */
+        if (info->number_types != n_types || info->number_leds != n_leds) {
+            VLOG_WARN("LED counts do not match in the led file of subsystem "
+                      "%s. Info says %d types and %d LEDs, while the file "
+                      "has %d and %d", subsystem, info->number_types,
+                      info->number_leds, n_types, n_leds);
+        }
+    }
+
+    for (idx = 0; idx < n_types; idx++) {
+        const YamlLedType *type = yaml_get_led_type(handle, subsystem, idx);
+
+        if (type != NULL && type->type != NULL) {
+            shash_add_once(&types, type->type, type);
+        }
+    }
+
+    leds = xcalloc(MAX(n_leds, 1), sizeof *leds);
+    for (idx = 0; idx < n_leds; idx++) {
+        const YamlLed *yaml_led = yaml_get_led(handle, subsystem, idx);
+        const i2c_bit_op *access;
+        const YamlLedType *type;
+        struct ledd_image_led *led;
+
+        if (yaml_led == NULL || yaml_led->name == NULL) {
+            continue;
+        }
+
+        led = &leds[n++];
+        led->name = ledd_image_add_string(&strings, &offsets, yaml_led->name);
+        led->type = ledd_image_add_string(&strings, &offsets, yaml_led->type);
+
+        type = (yaml_led->type != NULL
+                ? shash_find_data(&types, yaml_led->type) : NULL);
+        if (type != NULL) {
+            led->on = type->settings.on;
+            led->off = type->settings.off;
+            led->flashing = type->settings.flashing;
+        } else {
+            led->flags |= LEDD_IMAGE_LED_NO_TYPE;
+        }
+
+        access = yaml_led->led_access;
+        if (access != NULL && access->device != NULL) {
+            led->device = ledd_image_add_string(&strings, &offsets,
+                                                access->device);
+            led->reg = access->register_address;
+            led->size = access->register_size;
+            led->mask = access->bit_mask;
+        } else {
+            led->flags |= LEDD_IMAGE_LED_NO_ACCESS;
+        }
+    }
+
+    size = sizeof *header + n * sizeof *leds + strings.length;
+    base = xzalloc(size);
+    header = (struct ledd_image_header *)base;
+    header->magic = LEDD_IMAGE_MAGIC;
+    header->version = LEDD_IMAGE_VERSION;
+    header->size = size;
+    memcpy(header->digest, digest, SHA1_DIGEST_SIZE);
+    header->n_types = shash_count(&types);
+    header->n_leds = n;
+    header->strings = sizeof *header + n * sizeof *leds;
+    header->strings_size = strings.length;
+    memcpy(base + sizeof *header, leds, n * sizeof *leds);
+    memcpy(base + header->strings, strings.string, strings.length);
+    header->crc = crc32c((const uint8_t *)base + sizeof *header,
+                         size - sizeof *header);
+
+    image = xzalloc(sizeof *image);
+    image->header = header;
+    image->leds = (const struct ledd_image_led *)(base + sizeof *header);
+    image->strings = base + header->strings;
+    image->mapped = false;
+
+    free(leds);
+    ds_destroy(&strings);
+    shash_destroy(&offsets);
+    shash_destroy(&types);
+
+    return(image);
+} /* ledd_image_compile() */
+
+/* check that an image is sound and matches the digest of its source files */
+static const char *
+ledd_image_check(const char *base, size_t size,
+                 const uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    const struct ledd_image_header *header;
+    const struct ledd_image_led *leds;
+    uint32_t idx;
+
+    if (size < sizeof *header) {
+        return("truncated");
+    }
+    header = (const struct ledd_image_header *)base;
+    if (header->magic != LEDD_IMAGE_MAGIC) {
+        return("bad magic");
+    }
+    if (header->version != LEDD_IMAGE_VERSION) {
+        return("unsupported version");
+    }
+    if (header->size != size) {
+        return("bad size");
+    }
+    if (memcmp(header->digest, digest, SHA1_DIGEST_SIZE)) {
+        return("stale");
+    }
+    if (header->crc != crc32c((const uint8_t *)base + sizeof *header,
+                              size - sizeof *header)) {
+        return("bad checksum");
+    }
+    if (header->n_leds > (size - sizeof *header) / sizeof *leds
+        || header->strings != sizeof *header + header->n_leds * sizeof *leds
+        || header->strings_size == 0
+        || header->strings + header->strings_size != size
+        || base[size - 1] != '\0') {
+        return("bad layout");
+    }
+
+    leds = (const struct ledd_image_led *)(base + sizeof *header);
+    for (idx = 0; idx < header->n_leds; idx++) {
+        if (leds[idx].name >= header->strings_size
+            || leds[idx].type >= header->strings_size
+            || leds[idx].device >= header->strings_size) {
+            return("bad string offset");
+        }
+    }
+
+    return(NULL);
+} /* ledd_image_check() */
+
+/************************************************************************//**
+ * Function that maps a saved image, read-only.
+ *
+ * Returns: the image, to be freed with ledd_image_close(), or NULL if
+ *          there is no image at path or if it does not pass its checks
+ ***************************************************************************/
+struct ledd_image *
+ledd_image_open(const char *path, const uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    struct ledd_image *image;
+    const char *error;
+    struct stat st;
+    void *base;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            VLOG_WARN("%s: open failed (%s)", path, ovs_strerror(errno));
+        }
+        return(NULL);
+    }
+
+    if (fstat(fd, &st) < 0 || st.st_size < sizeof(struct ledd_image_header)
+        || st.st_size > UINT32_MAX) {
+        VLOG_WARN("%s: not an LED image", path);
+        close(fd);
+        return(NULL);
+    }
+
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        VLOG_WARN("%s: mmap failed (%s)", path, ovs_strerror(errno));
+        return(NULL);
+    }
+
+    error = ledd_image_check(base, st.st_size, digest);
+    if (error != NULL) {
+        VLOG_INFO("%s: ignoring LED image (%s)", path, error);
+        munmap(base, st.st_size);
+        return(NULL);
+    }
+
+    /* mark the image used, for ledd_image_prune() */
+    (void)utime(path, NULL);
+
+    image = xzalloc(sizeof *image);
+    image->header = base;
+    image->leds = (const struct ledd_image_led *)
+                  ((const char *)base + sizeof *image->header);
+    image->strings = (const char *)base + image->header->strings;
+    image->mapped = true;
+
+    return(image);
+} /* ledd_image_open() */
+
+/************************************************************************//**
+ * Function that saves an image to path. The image is written to a
+ *     temporary file of its own, in the same directory, that is renamed
+ *     into place, so a reader never sees a partial image, and processes
+ *     saving the same image at once do not write into the same file.
+ *
+ * Returns: 0, or an errno value
+ ***************************************************************************/
+int
+ledd_image_save(const struct ledd_image *image, const char *path)
+{
+    char *tmp = xasprintf("%s.XXXXXX", path);
+    int error = 0;
+    FILE *f = NULL;
+    int fd;
+
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        error = errno;
+    } else if (fchmod(fd, 0644) < 0 || (f = fdopen(fd, "w")) == NULL) {
+        error = errno;
+        close(fd);
+        unlink(tmp);
+    } else {
+        if (fwrite(image->header, image->header->size, 1, f) != 1) {
+            error = errno ? errno : EIO;
+        }
+        if (fclose(f) != 0 && !error) {
+            error = errno;
+        }
+        if (!error && rename(tmp, path) < 0) {
+            error = errno;
+        }
+        if (error) {
+            unlink(tmp);
+        }
+    }
+
+    if (error) {
+        VLOG_WARN("%s: unable to save LED image (%s)", path,
+                  ovs_strerror(error));
+    }
+    free(tmp);
+    return(error);
+} /* ledd_image_save() */
+
+void
+ledd_image_close(struct ledd_image *image)
+{
+    if (image != NULL) {
+        if (image->mapped) {
+            munmap(CONST_CAST(struct ledd_image_header *, image->header),
+                   image->header->size);
+        } else {
+            free(CONST_CAST(struct ledd_image_header *, image->header));
+        }
+        free(image);
+    }
+} /* ledd_image_close() */
+
+/* path of the image compiled from files with a digest, in dir */
+char *
+ledd_image_path(const char *dir, const uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    char hex[SHA1_HEX_DIGEST_LEN + 1];
+
+    sha1_to_hex(digest, hex);
+    return(xasprintf("%s/%s%s", dir, hex, LEDD_IMAGE_SUFFIX));
+} /* ledd_image_path() */
+
+/************************************************************************//**
+ * STRUCT of an image file found by ledd_image_prune().
+ ***************************************************************************/
+struct ledd_image_file {
+    char *path;                         /*!< Path of the image */
+    time_t mtime;                       /*!< Last saved or mapped */
+};
+
+/* order image files from the least recently used */
+static int
+ledd_image_file_compare(const void *a_, const void *b_)
+{
+    const struct ledd_image_file *a = a_;
+    const struct ledd_image_file *b = b_;
+
+    return(a->mtime < b->mtime ? -1 : a->mtime > b->mtime);
+} /* ledd_image_file_compare() */
+
+/************************************************************************//**
+ * Function that deletes the least recently used images in dir, so that at
+ *     most max are left. Images mapped by a process stay mapped when their
+ *     file is deleted; they are compiled again on its next start.
+ *
+ * Returns: void
+ ***************************************************************************/
+void
+ledd_image_prune(const char *dir, size_t max)
+{
+    struct ledd_image_file *files = NULL;
+    size_t n_files = 0, allocated = 0;
+    size_t suffix_len = strlen(LEDD_IMAGE_SUFFIX);
+    struct dirent *de;
+    size_t i;
+    DIR *d;
+
+    d = opendir(dir);
+    if (d == NULL) {
+        return;
+    }
+
+    while ((de = readdir(d)) != NULL) {
+        size_t len = strlen(de->d_name);
+        struct stat st;
+        char *path;
+
+        if (len <= suffix_len
+            || strcmp(de->d_name + len - suffix_len, LEDD_IMAGE_SUFFIX)) {
+            continue;
+        }
+
+        path = xasprintf("%s/%s", dir, de->d_name);
+        if (stat(path, &st) < 0 || !S_ISREG(st.st_mode)) {
+            free(path);
+            continue;
+        }
+
+        if (n_files >= allocated) {
+            files = x2nrealloc(files, &allocated, sizeof *files);
+        }
+        files[n_files].path = path;
+        files[n_files].mtime = st.st_mtime;
+        n_files++;
+    }
+    closedir(d);
+
+    if (n_files > max) {
+        qsort(files, n_files, sizeof *files, ledd_image_file_compare);
+        for (i = 0; i < n_files - max; i++) {
+            if (unlink(files[i].path) < 0 && errno != ENOENT) {
+                VLOG_WARN("%s: unable to delete LED image (%s)",
+                          files[i].path, ovs_strerror(errno));
+            } else {
+                VLOG_DBG("%s: deleted least recently used LED image",
+                         files[i].path);
+            }
+        }
+    }
+
+    for (i = 0; i < n_files; i++) {
+        free(files[i].path);
+    }
+    free(files);
+} /* ledd_image_prune() */
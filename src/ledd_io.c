@@ -0,0 +1,383 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd bus I/O workers
+ *
+ ***************************************************************************/
+
+#include <string.h>
+
+#include "config.h"
+#include "latch.h"
+#include "ovs-atomic.h"
+#include "ovs-thread.h"
+#include "poll-loop.h"
+#include "shash.h"
+#include "util.h"
+#include "openvswitch/vlog.h"
+
+#include "ledd_io.h"
+
+VLOG_DEFINE_THIS_MODULE(ledd_io);
+
+#define LEDD_IO_RING_SIZE 256   /*!< Jobs per ring, must be a power of 2 */
+
+/************************************************************************//**
+ * STRUCT of a single-producer single-consumer ring of jobs. The producer
+ * only writes tail and the consumer only writes head, so neither needs a
+ * lock: the release store of an index publishes the slots before it.
+ ***************************************************************************/
+struct ledd_io_ring {
+    struct ledd_io_job *slots[LEDD_IO_RING_SIZE]; /*!< Queued jobs */
+    ATOMIC(unsigned int) head;          /*!< Next slot to pop */
+    ATOMIC(unsigned int) tail;          /*!< Next slot to push */
+};
+
+/************************************************************************//**
+ * STRUCT of the worker thread for one i2c bus. The main thread produces
+ * requests and consumes completions; the worker does the opposite.
+ ***************************************************************************/
+struct ledd_io_worker {
+    char *bus;                          /*!< Bus name, from devices.yaml */
+    pthread_t thread;                   /*!< Worker thread */
+    struct latch wakeup;                /*!< Set when requests are queued */
+    ATOMIC(bool) exiting;               /*!< Set to stop the worker */
+    struct ledd_io_ring requests;       /*!< Main thread to worker */
+    struct ledd_io_ring completions;    /*!< Worker to main thread */
+    unsigned int n_inflight;            /*!< Jobs not yet polled back */
+    unsigned long long n_jobs;          /*!< Jobs submitted */
+    unsigned long long n_errors;        /*!< Jobs that failed */
+};
+
+/* set by any worker when it completes a job */
+static struct latch completion_latch;
+
+/* backend that runs the jobs, set once by ledd_io_init() */
+static const struct ledd_io_backend *backend;
+
+/* bus workers, keyed by bus name (main thread only) */
+static struct shash workers = SHASH_INITIALIZER(&workers);
+
+static bool
+ledd_io_ring_push(struct ledd_io_ring *ring, struct ledd_io_job *job)
+{
+    unsigned int head, tail;
+
+    atomic_read_relaxed(&ring->tail, &tail);
+    atomic_read_explicit(&ring->head, &head, memory_order_acquire);
+    if (tail - head >= LEDD_IO_RING_SIZE) {
+        return(false);
+    }
+
+    ring->slots[tail & (LEDD_IO_RING_SIZE - 1)] = job;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return(true);
+} /* ledd_io_ring_push() */
+
+static struct ledd_io_job *
+ledd_io_ring_pop(struct ledd_io_ring *ring)
+{
+    struct ledd_io_job *job;
+    unsigned int head, tail;
+
+    atomic_read_relaxed(&ring->head, &head);
+    atomic_read_explicit(&ring->tail, &tail, memory_order_acquire);
+    if (head == tail) {
+        return(NULL);
+    }
+
+    job = ring->slots[head & (LEDD_IO_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return(job);
+} /* ledd_io_ring_pop() */
+
+/* run a job on the bus through config-yaml, in a worker thread */
+static int
+ledd_io_i2c_execute(struct ledd_io_job *job)
+{
+    i2c_op op;
+    i2c_op *cmds[2];
+    int rc;
+
+    memset(&op, 0, sizeof(op));
+    op.direction = (job->op == LEDD_IO_READ) ? READ : WRITE;
+    op.device = CONST_CAST(char *, job->device);
+    op.register_address = job->reg;
+    op.byte_count = job->byte_count;
+    op.data = job->data;
+    op.set_register = true;
+    cmds[0] = &op;
+    cmds[1] = NULL;
+
+    rc = i2c_execute(job->handle, job->yaml_name, job->yaml_device, cmds);
+
+    return(rc);
+} /* ledd_io_i2c_execute() */
+
+static char *
+ledd_io_i2c_configure(const char *options)
+{
+    if (options != NULL && options[0] != '\0') {
+        return(xasprintf("i2c backend has no options"));
+    }
+    return(NULL);
+} /* ledd_io_i2c_configure() */
+
+static const struct ledd_io_backend ledd_io_i2c_backend = {
+    "i2c",
+    ledd_io_i2c_configure,
+    ledd_io_i2c_execute,
+    NULL,
+};
+
+static const struct ledd_io_backend *const backends[] = {
+    &ledd_io_i2c_backend,
+    &ledd_io_sim_backend,
+};
+
+/************************************************************************//**
+ * Function that is the main loop of a bus worker thread.
+ *
+ * Logic:
+ *     - clear the wakeup latch, then run every queued request, handing
+ *       each job back as soon as it is done
+ *     - sleep until more requests are queued, or until asked to exit
+ *
+ * The completion ring cannot overflow: the main thread never has more
+ * than LEDD_IO_RING_SIZE jobs in flight on a worker.
+ *
+ * Returns: NULL
+ ***************************************************************************/
+static void *
+ledd_io_worker_main(void *worker_)
+{
+    struct ledd_io_worker *worker = worker_;
+    struct ledd_io_job *job;
+    bool exiting;
+
+    for (;;) {
+        latch_poll(&worker->wakeup);
+
+        while ((job = ledd_io_ring_pop(&worker->requests)) != NULL) {
+            job->rc = backend->execute(job);
+            if (!ledd_io_ring_push(&worker->completions, job)) {
+                OVS_NOT_REACHED();
+            }
+            latch_set(&completion_latch);
+        }
+
+        atomic_read(&worker->exiting, &exiting);
+        if (exiting) {
+            break;
+        }
+
+        latch_wait(&worker->wakeup);
+        poll_block();
+    }
+
+    return(NULL);
+} /* ledd_io_worker_main() */
+
+/* find the worker for a bus, starting it if this is its first job */
+static struct ledd_io_worker *
+ledd_io_get_worker(const char *bus)
+{
+    struct ledd_io_worker *worker;
+
+    worker = shash_find_data(&workers, bus);
+    if (worker != NULL) {
+        return(worker);
+    }
+
+    worker = xzalloc(sizeof(*worker));
+    worker->bus = xstrdup(bus);
+    latch_init(&worker->wakeup);
+    atomic_init(&worker->exiting, false);
+    atomic_init(&worker->requests.head, 0);
+    atomic_init(&worker->requests.tail, 0);
+    atomic_init(&worker->completions.head, 0);
+    atomic_init(&worker->completions.tail, 0);
+    shash_add(&workers, bus, worker);
+
+    worker->thread = ovs_thread_create("ledd_io", ledd_io_worker_main, worker);
+    VLOG_DBG("started I/O worker for bus %s", bus);
+
+    return(worker);
+} /* ledd_io_get_worker() */
+
+/************************************************************************//**
+ * Function that queues a job on the worker for the bus of its device.
+ *     The job must not be touched until ledd_io_poll() hands it back.
+ *
+ * Returns: True if the job was queued, else False if the worker already
+ *          has as many jobs in flight as it can take
+ ***************************************************************************/
+bool
+ledd_io_submit(struct ledd_io_job *job)
+{
+    struct ledd_io_worker *worker;
+    const char *bus = job->yaml_device->bus;
+
+    worker = ledd_io_get_worker(bus != NULL ? bus : "");
+    if (worker->n_inflight >= LEDD_IO_RING_SIZE
+        || !ledd_io_ring_push(&worker->requests, job)) {
+        return(false);
+    }
+
+    worker->n_inflight++;
+    worker->n_jobs++;
+    latch_set(&worker->wakeup);
+
+    return(true);
+} /* ledd_io_submit() */
+
+/************************************************************************//**
+ * Function that returns the next completed job. Call it until it returns
+ *     NULL on each pass of the main loop, after the poll loop wakes up.
+ *
+ * Returns: a completed job, or NULL if there are none left
+ ***************************************************************************/
+struct ledd_io_job *
+ledd_io_poll(void)
+{
+    struct shash_node *node;
+    struct ledd_io_job *job;
+
+    /* Clear the latch before looking, so a completion posted after the
+       rings were drained still wakes up the next poll_block(). */
+    latch_poll(&completion_latch);
+
+    SHASH_FOR_EACH(node, &workers) {
+        struct ledd_io_worker *worker = node->data;
+
+        if (worker->n_inflight == 0) {
+            continue;
+        }
+
+        job = ledd_io_ring_pop(&worker->completions);
+        if (job != NULL) {
+            worker->n_inflight--;
+            if (job->rc != 0) {
+                worker->n_errors++;
+            }
+            return(job);
+        }
+    }
+
+    return(NULL);
+} /* ledd_io_poll() */
+
+/* arrange for the poll loop to wake up when a job completes */
+void
+ledd_io_wait(void)
+{
+    latch_wait(&completion_latch);
+} /* ledd_io_wait() */
+
+/************************************************************************//**
+ * Function that initializes the bus workers, with the backend given as
+ *     "name[:options]". The threads start with the first job.
+ *
+ * Returns: NULL, or an error message to be freed by the caller
+ ***************************************************************************/
+char *
+ledd_io_init(const char *spec)
+{
+    const char *colon = strchr(spec, ':');
+    size_t len = colon != NULL ? colon - spec : strlen(spec);
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(backends); i++) {
+        if (strlen(backends[i]->name) == len
+            && !strncmp(backends[i]->name, spec, len)) {
+            backend = backends[i];
+            break;
+        }
+    }
+    if (backend == NULL) {
+        return(xasprintf("unknown LED I/O backend \"%.*s\"", (int)len, spec));
+    }
+
+    latch_init(&completion_latch);
+
+    return(ledd_io_configure(colon != NULL ? colon + 1 : ""));
+} /* ledd_io_init() */
+
+/* apply "key=value,..." options to the backend */
+char *
+ledd_io_configure(const char *options)
+{
+    return(backend->configure(options));
+} /* ledd_io_configure() */
+
+/* add the name and full state of the backend to ds */
+void
+ledd_io_show(struct ds *ds)
+{
+    ds_put_format(ds, "LED I/O backend: %s\n", backend->name);
+    if (backend->show != NULL) {
+        backend->show(ds, true);
+    }
+} /* ledd_io_show() */
+
+/************************************************************************//**
+ * Function that stops the bus workers. A worker that is still on the bus
+ * (that has jobs in flight) is asked to exit but not waited for, so that
+ * a hung device cannot keep the daemon from exiting.
+ *
+ * Returns: void
+ ***************************************************************************/
+void
+ledd_io_exit(void)
+{
+    struct shash_node *node;
+
+    SHASH_FOR_EACH(node, &workers) {
+        struct ledd_io_worker *worker = node->data;
+
+        atomic_store(&worker->exiting, true);
+        latch_set(&worker->wakeup);
+        if (worker->n_inflight == 0) {
+            xpthread_join(worker->thread, NULL);
+        }
+    }
+} /* ledd_io_exit() */
+
+/* add the state of the bus workers to a support dump */
+void
+ledd_io_dump(struct ds *ds)
+{
+    struct shash_node *node;
+
+    ds_put_format(ds, "LED I/O backend: %s\n", backend->name);
+    if (backend->show != NULL) {
+        backend->show(ds, false);
+    }
+
+    SHASH_FOR_EACH(node, &workers) {
+        const struct ledd_io_worker *worker = node->data;
+
+        ds_put_format(ds, "Bus %s: %llu jobs, %llu failed, %u in flight\n",
+                      worker->bus[0] != '\0' ? worker->bus : "(none)",
+                      worker->n_jobs, worker->n_errors, worker->n_inflight);
+    }
+} /* ledd_io_dump() */
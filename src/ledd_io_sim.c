@@ -0,0 +1,393 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd simulated LED I/O backend
+ *
+ * The "sim" backend emulates the LED devices in memory: each device is a
+ * file of byte registers, created on first access and reading as zero
+ * until written. Every transaction takes a configurable latency, can be
+ * made to fail, and is recorded in a transaction log. Options, given to
+ * --led-io=sim:OPTIONS or to ops-ledd/io-backend, are:
+ *
+ *     latency=US       time each transaction takes, in us (default 0)
+ *     jitter=US        random extra time, from 0 to US (default 0)
+ *     fail_rate=PCT    percentage of transactions that fail (default 0)
+ *     fail_device=DEV  make every transaction on DEV fail (repeatable);
+ *                      "fail_device=" stops all device failures
+ *     log_size=N       transactions kept in the log (default 1024)
+ *     reset            clear the registers, counters and log
+ ***************************************************************************/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "dynamic-string.h"
+#include "hash.h"
+#include "hmap.h"
+#include "ovs-thread.h"
+#include "random.h"
+#include "sset.h"
+#include "timeval.h"
+#include "util.h"
+
+#include "ledd_io.h"
+
+#define SIM_DEFAULT_LOG_SIZE 1024       /*!< Default transaction log size */
+#define SIM_MAX_LOG_SIZE     65536      /*!< Largest transaction log */
+
+/************************************************************************//**
+ * STRUCT of one byte register of a simulated device.
+ ***************************************************************************/
+struct sim_reg {
+    struct hmap_node node;              /*!< In sim_device regs, by address */
+    uint32_t address;                   /*!< Register address */
+    uint8_t value;                      /*!< Register value */
+};
+
+/************************************************************************//**
+ * STRUCT of a simulated device and its register file.
+ ***************************************************************************/
+struct sim_device {
+    struct hmap_node node;              /*!< In sim_devices, by name */
+    char *name;                         /*!< Device name */
+    struct hmap regs;                   /*!< sim_reg structs */
+    unsigned long long reads;           /*!< Read transactions */
+    unsigned long long writes;          /*!< Write transactions */
+};
+
+/************************************************************************//**
+ * STRUCT of a transaction log entry.
+ ***************************************************************************/
+struct sim_log_entry {
+    long long int when;                 /*!< Start time, in us */
+    const char *device;                 /*!< Device name (owned by device) */
+    uint32_t reg;                       /*!< First register */
+    uint32_t byte_count;                /*!< Bytes transferred */
+    uint8_t data[4];                    /*!< First bytes transferred */
+    enum ledd_io_op op;                 /*!< Read or write */
+    int rc;                             /*!< Result */
+};
+
+/* Simulator state, shared by the bus workers, protected by sim_mutex. The
+   configuration is only written from the main thread, but read by the
+   workers, so it is protected too. */
+static struct ovs_mutex sim_mutex = OVS_MUTEX_INITIALIZER;
+static struct hmap sim_devices = HMAP_INITIALIZER(&sim_devices);
+static struct sset fail_devices = SSET_INITIALIZER(&fail_devices);
+static unsigned int latency_us;
+static unsigned int jitter_us;
+static unsigned int fail_rate;          /*!< In percent */
+static struct sim_log_entry *sim_log;
+static size_t log_size;
+static bool sim_initialized;
+static unsigned long long n_transactions; /*!< Also the next log slot */
+static unsigned long long n_failures;
+
+static struct sim_device *
+sim_get_device(const char *name)
+{
+    struct sim_device *device;
+    uint32_t hash = hash_string(name, 0);
+
+    HMAP_FOR_EACH_WITH_HASH(device, node, hash, &sim_devices) {
+        if (!strcmp(device->name, name)) {
+            return(device);
+        }
+    }
+
+    device = xzalloc(sizeof *device);
+    device->name = xstrdup(name);
+    hmap_init(&device->regs);
+    hmap_insert(&sim_devices, &device->node, hash);
+
+    return(device);
+} /* sim_get_device() */
+
+static struct sim_reg *
+sim_get_reg(struct sim_device *device, uint32_t address)
+{
+    struct sim_reg *reg;
+    uint32_t hash = hash_int(address, 0);
+
+    HMAP_FOR_EACH_WITH_HASH(reg, node, hash, &device->regs) {
+        if (reg->address == address) {
+            return(reg);
+        }
+    }
+
+    reg = xzalloc(sizeof *reg);
+    reg->address = address;
+    hmap_insert(&device->regs, &reg->node, hash);
+
+    return(reg);
+} /* sim_get_reg() */
+
+/* free every device and register, with sim_mutex held */
+static void
+sim_clear_devices(void)
+{
+    struct sim_device *device, *next_device;
+    struct sim_reg *reg, *next_reg;
+
+    HMAP_FOR_EACH_SAFE(device, next_device, node, &sim_devices) {
+        HMAP_FOR_EACH_SAFE(reg, next_reg, node, &device->regs) {
+            hmap_remove(&device->regs, &reg->node);
+            free(reg);
+        }
+        hmap_destroy(&device->regs);
+        hmap_remove(&sim_devices, &device->node);
+        free(device->name);
+        free(device);
+    }
+} /* sim_clear_devices() */
+
+static void
+sim_sleep(unsigned int us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR) {
+        continue;
+    }
+} /* sim_sleep() */
+
+/************************************************************************//**
+ * Function that runs a job against the simulated devices, in a bus worker
+ *     thread.
+ *
+ * Logic:
+ *     - wait for the latency of the transaction, plus a random jitter
+ *     - fail the transaction if its device is set to fail, or at random
+ *       at the failure rate
+ *     - else copy the data from or to the register file of the device,
+ *       one byte register per byte, from the first register up
+ *     - record the transaction in the log
+ *
+ * Returns: 0, or EIO if the transaction failed
+ ***************************************************************************/
+static int
+sim_execute(struct ledd_io_job *job)
+{
+    struct sim_device *device;
+    struct sim_log_entry *entry;
+    long long int when = time_usec();
+    unsigned int delay;
+    uint32_t idx;
+    int rc = 0;
+
+    ovs_mutex_lock(&sim_mutex);
+    delay = latency_us + (jitter_us ? random_range(jitter_us + 1) : 0);
+    ovs_mutex_unlock(&sim_mutex);
+
+    if (delay != 0) {
+        sim_sleep(delay);
+    }
+
+    ovs_mutex_lock(&sim_mutex);
+    device = sim_get_device(job->device);
+    if (sset_contains(&fail_devices, job->device)
+        || (fail_rate != 0 && random_range(100) < fail_rate)) {
+        rc = EIO;
+        n_failures++;
+    } else if (job->op == LEDD_IO_READ) {
+        for (idx = 0; idx < job->byte_count; idx++) {
+            job->data[idx] = sim_get_reg(device, job->reg + idx)->value;
+        }
+        device->reads++;
+    } else {
+        for (idx = 0; idx < job->byte_count; idx++) {
+            sim_get_reg(device, job->reg + idx)->value = job->data[idx];
+        }
+        device->writes++;
+    }
+
+    if (log_size != 0) {
+        entry = &sim_log[n_transactions % log_size];
+        entry->when = when;
+        entry->device = device->name;
+        entry->reg = job->reg;
+        entry->byte_count = job->byte_count;
+        memset(entry->data, 0, sizeof entry->data);
+        memcpy(entry->data, job->data,
+               MIN(job->byte_count, sizeof entry->data));
+        entry->op = job->op;
+        entry->rc = rc;
+    }
+    n_transactions++;
+    ovs_mutex_unlock(&sim_mutex);
+
+    return(rc);
+} /* sim_execute() */
+
+/* parse an unsigned option value */
+static char *
+sim_parse_uint(const char *key, const char *value, unsigned int max,
+               unsigned int *uintp)
+{
+    if (!str_to_uint(value, 10, uintp) || *uintp > max) {
+        return(xasprintf("%s must be a number from 0 to %u", key, max));
+    }
+    return(NULL);
+} /* sim_parse_uint() */
+
+/* resize the transaction log, with sim_mutex held; entries are dropped */
+static void
+sim_set_log_size(size_t size)
+{
+    free(sim_log);
+    sim_log = size ? xcalloc(size, sizeof *sim_log) : NULL;
+    log_size = size;
+    n_transactions = 0;
+} /* sim_set_log_size() */
+
+/************************************************************************//**
+ * Function that applies "key=value,..." options to the simulator (see the
+ *     top of this file). Options are applied in order, up to the first bad
+ *     one.
+ *
+ * Returns: NULL, or an error message to be freed by the caller
+ ***************************************************************************/
+static char *
+sim_configure(const char *options)
+{
+    char *copy, *save_ptr = NULL;
+    char *token;
+    char *error = NULL;
+
+    ovs_mutex_lock(&sim_mutex);
+    if (!sim_initialized) {
+        sim_set_log_size(SIM_DEFAULT_LOG_SIZE);
+        sim_initialized = true;
+    }
+
+    copy = xstrdup(options);
+    for (token = strtok_r(copy, ", ", &save_ptr);
+         token != NULL && error == NULL;
+         token = strtok_r(NULL, ", ", &save_ptr)) {
+        char *value = strchr(token, '=');
+        unsigned int n;
+
+        if (value != NULL) {
+            *value++ = '\0';
+        }
+
+        if (!strcmp(token, "reset") && value == NULL) {
+            sim_clear_devices();
+            sim_set_log_size(log_size);
+            n_failures = 0;
+        } else if (value == NULL) {
+            error = xasprintf("option %s needs a value", token);
+        } else if (!strcmp(token, "latency")) {
+            error = sim_parse_uint(token, value, 10000000, &latency_us);
+        } else if (!strcmp(token, "jitter")) {
+            error = sim_parse_uint(token, value, 10000000, &jitter_us);
+        } else if (!strcmp(token, "fail_rate")) {
+            error = sim_parse_uint(token, value, 100, &fail_rate);
+        } else if (!strcmp(token, "fail_device")) {
+            if (value[0] == '\0') {
+                sset_clear(&fail_devices);
+            } else {
+                sset_add(&fail_devices, value);
+            }
+        } else if (!strcmp(token, "log_size")) {
+            error = sim_parse_uint(token, value, SIM_MAX_LOG_SIZE, &n);
+            if (error == NULL) {
+                sim_set_log_size(n);
+            }
+        } else {
+            error = xasprintf("unknown sim option %s", token);
+        }
+    }
+    free(copy);
+    ovs_mutex_unlock(&sim_mutex);
+
+    return(error);
+} /* sim_configure() */
+
+/* add the simulator state to ds: configuration and counters, and if
+   verbose is set, the register files and the transaction log */
+static void
+sim_show(struct ds *ds, bool verbose)
+{
+    const struct sim_device *device;
+    const struct sim_reg *reg;
+    const char *name;
+    unsigned long long first;
+    unsigned long long i;
+
+    ovs_mutex_lock(&sim_mutex);
+    ds_put_format(ds, "Sim latency: %u us (+ up to %u us), "
+                  "failure rate: %u%%\n", latency_us, jitter_us, fail_rate);
+    SSET_FOR_EACH(name, &fail_devices) {
+        ds_put_format(ds, "Sim failing device: %s\n", name);
+    }
+    ds_put_format(ds, "Sim transactions: %llu, failed: %llu\n",
+                  n_transactions, n_failures);
+
+    HMAP_FOR_EACH(device, node, &sim_devices) {
+        ds_put_format(ds, "Sim device %s: %llu reads, %llu writes\n",
+                      device->name, device->reads, device->writes);
+        if (verbose) {
+            HMAP_FOR_EACH(reg, node, &device->regs) {
+                ds_put_format(ds, "\t0x%x: 0x%02x\n", reg->address,
+                              reg->value);
+            }
+        }
+    }
+
+    if (verbose && log_size != 0) {
+        first = n_transactions > log_size ? n_transactions - log_size : 0;
+        ds_put_format(ds, "Sim transaction log (last %llu):\n",
+                      n_transactions - first);
+        for (i = first; i < n_transactions; i++) {
+            const struct sim_log_entry *entry = &sim_log[i % log_size];
+            uint32_t idx;
+
+            ds_put_format(ds, "\t%lld.%06lld %s %s 0x%x",
+                          entry->when / 1000000, entry->when % 1000000,
+                          entry->op == LEDD_IO_READ ? "read " : "write",
+                          entry->device, entry->reg);
+            for (idx = 0; idx < MIN(entry->byte_count, sizeof entry->data);
+                 idx++) {
+                ds_put_format(ds, " %02x", entry->data[idx]);
+            }
+            if (entry->byte_count > sizeof entry->data) {
+                ds_put_cstr(ds, " ...");
+            }
+            if (entry->rc != 0) {
+                ds_put_format(ds, " failed (%d)", entry->rc);
+            }
+            ds_put_char(ds, '\n');
+        }
+    }
+    ovs_mutex_unlock(&sim_mutex);
+} /* sim_show() */
+
+const struct ledd_io_backend ledd_io_sim_backend = {
+    "sim",
+    sim_configure,
+    sim_execute,
+    sim_show,
+};
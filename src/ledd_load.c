@@ -0,0 +1,458 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd hardware description loader
+ *
+ ***************************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "config.h"
+#include "hash.h"
+#include "latch.h"
+#include "ovs-thread.h"
+#include "svec.h"
+#include "timeval.h"
+#include "util.h"
+#include "openvswitch/vlog.h"
+
+#include "ledd_load.h"
+
+VLOG_DEFINE_THIS_MODULE(ledd_load);
+
+/* Loads waiting for a thread, loads done and the descriptor cache,
+   protected by load_mutex. Threads are started as loads are queued, up
+   to max_threads. */
+static struct ovs_mutex load_mutex = OVS_MUTEX_INITIALIZER;
+static pthread_cond_t load_cond;
+static struct ovs_list load_queue = OVS_LIST_INITIALIZER(&load_queue);
+static struct ovs_list load_done = OVS_LIST_INITIALIZER(&load_done);
+static int n_idle;                      /*!< Threads waiting for a load */
+static int n_threads;                   /*!< Threads started */
+static int max_threads;                 /*!< Size of the pool */
+static struct hmap descs = HMAP_INITIALIZER(&descs);
+static char *image_dir;                 /*!< Saved images, NULL if none */
+
+/* set when a load is done */
+static struct latch load_latch;
+
+/************************************************************************//**
+ * Function that computes the digest of the hardware description files of
+ *     a directory: every .yaml file, in name order, names and contents.
+ *
+ * Returns: void
+ ***************************************************************************/
+static void
+ledd_load_digest(const char *dir, uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    struct svec names = SVEC_EMPTY_INITIALIZER;
+    struct sha1_ctx ctx;
+    struct dirent *de;
+    const char *name;
+    DIR *d;
+    size_t i;
+
+    d = opendir(dir);
+    if (d != NULL) {
+        while ((de = readdir(d)) != NULL) {
+            size_t len = strlen(de->d_name);
+
+            if (len > 5 && !strcmp(de->d_name + len - 5, ".yaml")) {
+                svec_add(&names, de->d_name);
+            }
+        }
+        closedir(d);
+    }
+    svec_sort(&names);
+
+    sha1_init(&ctx);
+    SVEC_FOR_EACH(i, name, &names) {
+        char *path = xasprintf("%s/%s", dir, name);
+        char buf[4096];
+        size_t n;
+        FILE *f;
+
+        sha1_update(&ctx, name, strlen(name) + 1);
+        f = fopen(path, "r");
+        if (f != NULL) {
+            while ((n = fread(buf, 1, sizeof buf, f)) > 0) {
+                sha1_update(&ctx, buf, n);
+            }
+            fclose(f);
+        }
+        free(path);
+    }
+    sha1_final(&ctx, digest);
+
+    svec_destroy(&names);
+} /* ledd_load_digest() */
+
+static uint32_t
+ledd_desc_hash(const char *dir, const uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    return(hash_bytes(digest, SHA1_DIGEST_SIZE, hash_string(dir, 0)));
+} /* ledd_desc_hash() */
+
+/* find a cached descriptor, with load_mutex held */
+static struct ledd_desc *
+ledd_desc_find(const char *dir, const uint8_t digest[SHA1_DIGEST_SIZE])
+{
+    struct ledd_desc *desc;
+
+    HMAP_FOR_EACH_WITH_HASH(desc, node, ledd_desc_hash(dir, digest), &descs) {
+        if (!strcmp(desc->dir, dir)
+            && !memcmp(desc->digest, digest, SHA1_DIGEST_SIZE)) {
+            return(desc);
+        }
+    }
+
+    return(NULL);
+} /* ledd_desc_find() */
+
+/* free a descriptor that is out of the cache */
+static void
+ledd_desc_free(struct ledd_desc *desc)
+{
+    ledd_image_close(desc->image);
+    if (desc->handle != NULL) {
+        yaml_free_config_handle(desc->handle);
+    }
+    free(desc->dir);
+    free(desc->name);
+    free(desc);
+} /* ledd_desc_free() */
+
+/************************************************************************//**
+ * Function that parses the hardware description files of a subsystem
+ *     into its descriptor, in a loader thread.
+ *
+ * Logic:
+ *     - parse the manifest and the devices file into the yaml handle
+ *     - map the saved image of the LED descriptions, if there is one for
+ *       files with this digest
+ *     - else parse the led file, compile it into an image, and save it
+ *
+ * Returns: 0, or the error of the stage that failed (set in load->failed)
+ ***************************************************************************/
+static int
+ledd_load_parse(struct ledd_load *load, struct ledd_desc *desc)
+{
+    char *path = NULL;
+    int rc;
+
+    desc->handle = yaml_new_config_handle();
+
+    rc = yaml_add_subsystem(desc->handle, desc->name, desc->dir);
+    load->times.added = time_usec();
+    if (rc != 0) {
+        load->failed = "h/w description files";
+        return(rc);
+    }
+
+    rc = yaml_parse_devices(desc->handle, desc->name);
+    load->times.devices = time_usec();
+    if (rc != 0) {
+        load->failed = "devices file";
+        return(rc);
+    }
+
+    if (image_dir != NULL) {
+        path = ledd_image_path(image_dir, desc->digest);
+        desc->image = ledd_image_open(path, desc->digest);
+    }
+    if (desc->image != NULL) {
+        desc->from_image = true;
+    } else {
+        rc = yaml_parse_leds(desc->handle, desc->name);
+        if (rc != 0) {
+            load->failed = "led file";
+            free(path);
+            return(rc);
+        }
+        desc->image = ledd_image_compile(desc->handle, desc->name,
+                                         desc->digest);
+        if (path != NULL && !ledd_image_save(desc->image, path)) {
+            ledd_image_prune(image_dir, LEDD_IMAGE_MAX_FILES);
+        }
+    }
+    load->times.leds = time_usec();
+    free(path);
+
+    return(0);
+} /* ledd_load_parse() */
+
+/************************************************************************//**
+ * Function that loads a subsystem, in a loader thread.
+ *
+ * Logic:
+ *     - digest the hardware description files
+ *     - if a descriptor with the same directory and digest is cached,
+ *       take a reference on it; if it is still being parsed, wait for it
+ *       on its list of waiters rather than hold up the thread
+ *     - else cache a new descriptor, parse the files into it, and hand
+ *       back the load and its waiters; on failure, the descriptor is
+ *       dropped and every waiter fails the same way
+ *
+ * Returns: void (with load_mutex held, as on entry)
+ ***************************************************************************/
+static void
+ledd_load_run(struct ledd_load *load)
+{
+    uint8_t digest[SHA1_DIGEST_SIZE];
+    struct ledd_load *waiter;
+    struct ledd_desc *desc;
+    int rc;
+
+    ovs_mutex_unlock(&load_mutex);
+    load->times.started = time_usec();
+    ledd_load_digest(load->dir, digest);
+    load->times.hashed = time_usec();
+    ovs_mutex_lock(&load_mutex);
+
+    desc = ledd_desc_find(load->dir, digest);
+    if (desc != NULL) {
+        desc->ref_cnt++;
+        load->desc = desc;
+        load->shared = true;
+        if (desc->loading) {
+            list_push_back(&desc->waiters, &load->node);
+        } else {
+            list_push_back(&load_done, &load->node);
+            latch_set(&load_latch);
+        }
+        return;
+    }
+
+    desc = xzalloc(sizeof *desc);
+    desc->dir = xstrdup(load->dir);
+    memcpy(desc->digest, digest, SHA1_DIGEST_SIZE);
+    desc->name = xstrdup(load->name);
+    desc->ref_cnt = 1;
+    desc->loading = true;
+    list_init(&desc->waiters);
+    hmap_insert(&descs, &desc->node, ledd_desc_hash(desc->dir, digest));
+    ovs_mutex_unlock(&load_mutex);
+
+    rc = ledd_load_parse(load, desc);
+
+    ovs_mutex_lock(&load_mutex);
+    desc->loading = false;
+    load->rc = rc;
+    load->desc = desc;
+    LIST_FOR_EACH_POP(waiter, node, &desc->waiters) {
+        if (rc != 0) {
+            waiter->rc = rc;
+            waiter->failed = load->failed;
+            waiter->desc = NULL;
+        }
+        list_push_back(&load_done, &waiter->node);
+    }
+    if (rc != 0) {
+        hmap_remove(&descs, &desc->node);
+        ledd_desc_free(desc);
+        load->desc = NULL;
+    }
+    list_push_back(&load_done, &load->node);
+    latch_set(&load_latch);
+} /* ledd_load_run() */
+
+static void *
+ledd_load_thread_main(void *arg OVS_UNUSED)
+{
+    struct ledd_load *load;
+
+    ovs_mutex_lock(&load_mutex);
+    for (;;) {
+        while (list_is_empty(&load_queue)) {
+            n_idle++;
+            ovs_mutex_cond_wait(&load_cond, &load_mutex);
+            n_idle--;
+        }
+
+        load = CONTAINER_OF(list_pop_front(&load_queue),
+                            struct ledd_load, node);
+        ledd_load_run(load);
+    }
+
+    return(NULL);
+} /* ledd_load_thread_main() */
+
+/* initialize the loader, for a pool of up to n threads (0 for one per
+   CPU core), saving LED images in dir (NULL not to) */
+void
+ledd_load_init(int n, const char *dir)
+{
+    if (n <= 0) {
+        n = count_cpu_cores();
+    }
+    max_threads = MIN(MAX(n, 1), LEDD_LOAD_MAX_THREADS);
+
+    if (dir != NULL && dir[0] != '\0') {
+        if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+            VLOG_WARN("%s: unable to create LED image directory (%s)",
+                      dir, ovs_strerror(errno));
+        }
+        image_dir = xstrdup(dir);
+    }
+
+    xpthread_cond_init(&load_cond, NULL);
+    latch_init(&load_latch);
+} /* ledd_load_init() */
+
+/* the size of the loader thread pool */
+int
+ledd_load_n_threads(void)
+{
+    return(max_threads);
+} /* ledd_load_n_threads() */
+
+struct ledd_load *
+ledd_load_create(const char *name, const char *dir)
+{
+    struct ledd_load *load = xzalloc(sizeof *load);
+
+    load->name = xstrdup(name);
+    load->dir = xstrdup(dir);
+    return(load);
+} /* ledd_load_create() */
+
+/* free a load; its descriptor reference, if any, belongs to the caller */
+void
+ledd_load_destroy(struct ledd_load *load)
+{
+    if (load != NULL) {
+        free(load->name);
+        free(load->dir);
+        free(load);
+    }
+} /* ledd_load_destroy() */
+
+/************************************************************************//**
+ * Function that queues the load of a subsystem for the thread pool,
+ *     starting a new thread if none is idle and the pool is not full.
+ *
+ * Returns: void
+ ***************************************************************************/
+void
+ledd_load_submit(struct ledd_load *load)
+{
+    bool start;
+
+    load->times.queued = time_usec();
+
+    ovs_mutex_lock(&load_mutex);
+    list_push_back(&load_queue, &load->node);
+    start = (n_idle == 0 && n_threads < max_threads);
+    if (start) {
+        n_threads++;
+    }
+    xpthread_cond_signal(&load_cond);
+    ovs_mutex_unlock(&load_mutex);
+
+    if (start) {
+        ovs_thread_create("ledd_load", ledd_load_thread_main, NULL);
+        VLOG_DBG("started loader thread %d of %d", n_threads, max_threads);
+    }
+} /* ledd_load_submit() */
+
+/************************************************************************//**
+ * Function that returns the next load that is done. Call it until it
+ *     returns NULL on each pass of the main loop.
+ *
+ * Returns: a load that is done, or NULL if there are none left
+ ***************************************************************************/
+struct ledd_load *
+ledd_load_poll(void)
+{
+    struct ledd_load *load = NULL;
+
+    ovs_mutex_lock(&load_mutex);
+    if (!list_is_empty(&load_done)) {
+        load = CONTAINER_OF(list_pop_front(&load_done),
+                            struct ledd_load, node);
+    } else {
+        latch_poll(&load_latch);
+    }
+    ovs_mutex_unlock(&load_mutex);
+
+    return(load);
+} /* ledd_load_poll() */
+
+/* arrange for the poll loop to wake up when a load is done */
+void
+ledd_load_wait(void)
+{
+    latch_wait(&load_latch);
+} /* ledd_load_wait() */
+
+/* take a reference on a descriptor */
+void
+ledd_desc_ref(struct ledd_desc *desc)
+{
+    ovs_mutex_lock(&load_mutex);
+    desc->ref_cnt++;
+    ovs_mutex_unlock(&load_mutex);
+} /* ledd_desc_ref() */
+
+/* drop a reference on a descriptor, freeing it with the last one */
+void
+ledd_desc_unref(struct ledd_desc *desc)
+{
+    bool last;
+
+    if (desc == NULL) {
+        return;
+    }
+
+    ovs_mutex_lock(&load_mutex);
+    last = (--desc->ref_cnt == 0);
+    if (last) {
+        hmap_remove(&descs, &desc->node);
+    }
+    ovs_mutex_unlock(&load_mutex);
+
+    if (last) {
+        ledd_desc_free(desc);
+    }
+} /* ledd_desc_unref() */
+
+/* add the cached descriptors to a support dump */
+void
+ledd_desc_dump(struct ds *ds)
+{
+    const struct ledd_desc *desc;
+
+    ovs_mutex_lock(&load_mutex);
+    HMAP_FOR_EACH(desc, node, &descs) {
+        char hex[SHA1_HEX_DIGEST_LEN + 1];
+
+        sha1_to_hex(desc->digest, hex);
+        ds_put_format(ds, "Descriptor %s (%.12s): %d users, %s\n", desc->dir,
+                      hex, desc->ref_cnt,
+                      desc->loading ? "loading"
+                      : desc->from_image ? "from image" : "from yaml");
+    }
+    ovs_mutex_unlock(&load_mutex);
+} /* ledd_desc_dump() */
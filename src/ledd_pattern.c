@@ -0,0 +1,245 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd LED patterns
+ *
+ ***************************************************************************/
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "util.h"
+
+#include "ledd_pattern.h"
+
+/* patterns every subsystem knows about */
+static const struct {
+    const char *name;
+    const char *def;
+} builtin_defs[] = {
+    { LEDD_PATTERN_DEFAULT, "on 500, off 500" },
+    { "fast",               "on 125, off 125" },
+    { "slow",               "on 1000, off 1000" },
+    { "heartbeat",          "on 100, off 100, on 100, off 700" },
+    { "blink3",             "on 200, off 200, on 200, off 200, "
+                            "on 200, off 1000" },
+};
+
+static struct ledd_pattern *builtins[ARRAY_SIZE(builtin_defs)];
+
+/************************************************************************//**
+ * Function that compiles a pattern definition into a step table.
+ *
+ * Logic:
+ *     - split the definition into comma separated steps
+ *     - each step is "on <ms>" or "off <ms>"; a final "once" makes the
+ *       pattern run only once
+ *     - record the end time of each step, from the start of the pattern
+ *
+ * Returns: the pattern, or NULL with *errorp set to an error message
+ *          (to be freed by the caller) if the definition is not valid
+ ***************************************************************************/
+struct ledd_pattern *
+ledd_pattern_parse(const char *name, const char *def, char **errorp)
+{
+    struct ledd_pattern *pattern;
+    char *copy, *save_ptr = NULL;
+    char *token;
+    unsigned int end = 0;
+
+    *errorp = NULL;
+
+    pattern = xzalloc(sizeof *pattern);
+    pattern->name = xstrdup(name);
+    pattern->steps = xcalloc(LEDD_PATTERN_MAX_STEPS, sizeof *pattern->steps);
+
+    copy = xstrdup(def);
+    for (token = strtok_r(copy, ",", &save_ptr); token != NULL;
+         token = strtok_r(NULL, ",", &save_ptr)) {
+        char word[8];
+        unsigned int ms;
+        int n = 0;
+
+        if (pattern->once) {
+            *errorp = xasprintf("\"once\" must be the last step");
+            break;
+        }
+
+        if (sscanf(token, " %7s %n", word, &n) == 1
+            && !strcmp(word, "once") && token[n] == '\0') {
+            pattern->once = true;
+            continue;
+        }
+
+        if (sscanf(token, " %7s %u %n", word, &ms, &n) != 2
+            || token[n] != '\0'
+            || (strcmp(word, "on") && strcmp(word, "off"))) {
+            *errorp = xasprintf("invalid step \"%s\"", token);
+            break;
+        }
+        if (ms > LEDD_PATTERN_MAX_MS) {
+            *errorp = xasprintf("step longer than %d ms", LEDD_PATTERN_MAX_MS);
+            break;
+        }
+        if (ms == 0) {
+            continue;
+        }
+        if (pattern->n_steps >= LEDD_PATTERN_MAX_STEPS) {
+            *errorp = xasprintf("more than %d steps", LEDD_PATTERN_MAX_STEPS);
+            break;
+        }
+
+        end += ms;
+        pattern->steps[pattern->n_steps].on = !strcmp(word, "on");
+        pattern->steps[pattern->n_steps].end = end;
+        pattern->n_steps++;
+    }
+    free(copy);
+
+    if (*errorp == NULL && pattern->n_steps == 0) {
+        *errorp = xasprintf("no steps");
+    }
+    if (*errorp != NULL) {
+        ledd_pattern_destroy(pattern);
+        return(NULL);
+    }
+
+    pattern->cycle = end;
+    return(pattern);
+} /* ledd_pattern_parse() */
+
+void
+ledd_pattern_destroy(struct ledd_pattern *pattern)
+{
+    if (pattern != NULL) {
+        free(pattern->name);
+        free(pattern->steps);
+        free(pattern);
+    }
+} /* ledd_pattern_destroy() */
+
+/* find a built-in pattern by name, compiling the built-ins on first use */
+const struct ledd_pattern *
+ledd_pattern_builtin(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < ARRAY_SIZE(builtin_defs); i++) {
+        if (strcmp(builtin_defs[i].name, name) == 0) {
+            if (builtins[i] == NULL) {
+                char *error;
+
+                builtins[i] = ledd_pattern_parse(builtin_defs[i].name,
+                                                 builtin_defs[i].def, &error);
+                ovs_assert(builtins[i] != NULL);
+            }
+            return(builtins[i]);
+        }
+    }
+
+    return(NULL);
+} /* ledd_pattern_builtin() */
+
+/************************************************************************//**
+ * Function that finds the step of a pattern that is running at time t,
+ *     in ms from the start of the pattern (t >= 0).
+ *
+ * Returns: the step index; *next is set to the time the step ends, in ms
+ *          from the start of the pattern, or to LLONG_MAX if a one-shot
+ *          pattern is over and holds its last step
+ ***************************************************************************/
+size_t
+ledd_pattern_step_at(const struct ledd_pattern *pattern, long long int t,
+                     long long int *next)
+{
+    long long int cycle_start;
+    unsigned int offset;
+    size_t low, high;
+
+    if (pattern->once && t >= pattern->cycle) {
+        *next = LLONG_MAX;
+        return(pattern->n_steps - 1);
+    }
+
+    offset = t % pattern->cycle;
+    cycle_start = t - offset;
+
+    /* first step that ends after offset */
+    low = 0;
+    high = pattern->n_steps - 1;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+
+        if (pattern->steps[mid].end > offset) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    *next = cycle_start + pattern->steps[low].end;
+    return(low);
+} /* ledd_pattern_step_at() */
+
+/************************************************************************//**
+ * Function that finds whether a pattern is a plain repeating blink, one
+ *     time on and one time off, as the kernel LED timer trigger runs.
+ *
+ * Returns: True with *on_ms and *off_ms set if it is, else False
+ ***************************************************************************/
+bool
+ledd_pattern_is_blink(const struct ledd_pattern *pattern,
+                      unsigned int *on_ms, unsigned int *off_ms)
+{
+    unsigned int on = 0;
+    unsigned int start = 0;
+    size_t changes = 0;
+    size_t idx;
+
+    if (pattern->once) {
+        return(false);
+    }
+
+    for (idx = 0; idx < pattern->n_steps; idx++) {
+        const struct ledd_pattern_step *step = &pattern->steps[idx];
+        const struct ledd_pattern_step *prev;
+
+        /* the pattern repeats, so the first step follows the last one */
+        prev = &pattern->steps[idx ? idx - 1 : pattern->n_steps - 1];
+        if (step->on != prev->on) {
+            changes++;
+        }
+        if (step->on) {
+            on += step->end - start;
+        }
+        start = step->end;
+    }
+
+    if (changes != 2) {
+        return(false);
+    }
+
+    *on_ms = on;
+    *off_ms = pattern->cycle - on;
+    return(true);
+} /* ledd_pattern_is_blink() */
@@ -0,0 +1,184 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd main loop profiler
+ *
+ ***************************************************************************/
+
+#include <string.h>
+
+#include "config.h"
+#include "dynamic-string.h"
+#include "timeval.h"
+#include "util.h"
+
+#include "ledd_hist.h"
+#include "ledd_prof.h"
+
+static const char *phase_names[LEDD_NUM_PHASES] = {
+    "idl_run", "reconfigure", "bus", "commit", "unixctl", "other", "poll"
+};
+
+static const char *wakeup_names[LEDD_NUM_WAKEUPS] = {
+    "idl", "timer", "unixctl", "worker", "other"
+};
+
+/* profiler state; only the main thread uses it */
+static struct {
+    enum ledd_phase phase;              /* Phase being run */
+    long long int mark;                 /* Start of the phase, in us */
+    long long int pass_start;           /* Return of poll_block(), in us */
+    unsigned int causes;                /* Wakeup causes of this pass */
+    unsigned long long pass_us[LEDD_NUM_PHASES]; /* Time in this pass */
+    unsigned long long total_us[LEDD_NUM_PHASES]; /* Time since reset */
+    unsigned long long max_us[LEDD_NUM_PHASES]; /* Most in one pass */
+    unsigned long long wakeups[LEDD_NUM_WAKEUPS]; /* Passes, by cause */
+    unsigned long long passes;          /* Passes since reset */
+    struct ledd_hist busy;              /* Busy time of each pass, in us */
+    long long int reset_time;           /* Last reset, in us */
+} prof;
+
+void
+ledd_prof_init(void)
+{
+    long long int now = time_usec();
+
+    prof.phase = LEDD_PHASE_OTHER;
+    prof.mark = now;
+    prof.pass_start = now;
+    prof.reset_time = now;
+} /* ledd_prof_init() */
+
+/* charge the time since the last switch to the current phase, and enter
+   a new one */
+void
+ledd_prof_switch(enum ledd_phase phase)
+{
+    long long int now = time_usec();
+
+    prof.pass_us[prof.phase] += now - prof.mark;
+    prof.mark = now;
+    prof.phase = phase;
+} /* ledd_prof_switch() */
+
+/* note that this pass found work for a wakeup cause */
+void
+ledd_prof_wakeup(enum ledd_wakeup cause)
+{
+    prof.causes |= 1u << cause;
+} /* ledd_prof_wakeup() */
+
+/************************************************************************//**
+ * Function that ends a pass through the main loop, before it blocks.
+ *
+ * Logic:
+ *     - add the time of each phase in the pass to its total and max
+ *     - record the busy time of the pass
+ *     - count the wakeup that started the pass under each of its causes,
+ *       or under "other"
+ *     - enter the poll phase
+ *
+ * Returns: the wakeup causes of the pass, as a bit per enum ledd_wakeup
+ ***************************************************************************/
+unsigned int
+ledd_prof_end_pass(void)
+{
+    unsigned int causes;
+    int i;
+
+    ledd_prof_switch(LEDD_PHASE_POLL);
+
+    for (i = 0; i < LEDD_NUM_PHASES; i++) {
+        prof.total_us[i] += prof.pass_us[i];
+        prof.max_us[i] = MAX(prof.max_us[i], prof.pass_us[i]);
+        prof.pass_us[i] = 0;
+    }
+    ledd_hist_record(&prof.busy, prof.mark - prof.pass_start);
+
+    causes = prof.causes ? prof.causes : 1u << LEDD_WAKEUP_OTHER;
+    for (i = 0; i < LEDD_NUM_WAKEUPS; i++) {
+        if (causes & (1u << i)) {
+            prof.wakeups[i]++;
+        }
+    }
+    prof.causes = 0;
+    prof.passes++;
+
+    return(causes);
+} /* ledd_prof_end_pass() */
+
+/* start a pass through the main loop, after poll_block() returns */
+void
+ledd_prof_start_pass(void)
+{
+    long long int now = time_usec();
+
+    prof.total_us[LEDD_PHASE_POLL] += now - prof.mark;
+    prof.max_us[LEDD_PHASE_POLL] = MAX(prof.max_us[LEDD_PHASE_POLL],
+                                       now - prof.mark);
+    prof.mark = now;
+    prof.pass_start = now;
+    prof.phase = LEDD_PHASE_OTHER;
+} /* ledd_prof_start_pass() */
+
+void
+ledd_prof_show(struct ds *ds)
+{
+    long long int elapsed = MAX(time_usec() - prof.reset_time, 1);
+    int i;
+
+    ds_put_format(ds, "Main loop: %llu passes in %.1f s, busy %.2f%%\n",
+                  prof.passes, elapsed / 1e6,
+                  100.0 * (elapsed - prof.total_us[LEDD_PHASE_POLL])
+                  / elapsed);
+
+    ds_put_cstr(ds, "Wakeups:");
+    for (i = 0; i < LEDD_NUM_WAKEUPS; i++) {
+        ds_put_format(ds, " %s %llu", wakeup_names[i], prof.wakeups[i]);
+    }
+    ds_put_char(ds, '\n');
+
+    ds_put_format(ds, "\n%-12s %12s %10s %10s %7s\n",
+                  "Phase", "total (ms)", "mean (us)", "max (us)", "time");
+    for (i = 0; i < LEDD_NUM_PHASES; i++) {
+        ds_put_format(ds, "%-12s %12.1f %10llu %10llu %6.2f%%\n",
+                      phase_names[i], prof.total_us[i] / 1000.0,
+                      prof.passes ? prof.total_us[i] / prof.passes : 0,
+                      prof.max_us[i], 100.0 * prof.total_us[i] / elapsed);
+    }
+
+    ds_put_format(ds, "\n%-12s %8s %8s %8s %8s %8s %8s %8s %8s\n",
+                  "Pass (us)", "count", "min", "mean", "p50", "p90", "p99",
+                  "p99.9", "max");
+    ds_put_format(ds, "%-12s ", "busy");
+    ledd_hist_format(ds, &prof.busy);
+    ds_put_char(ds, '\n');
+} /* ledd_prof_show() */
+
+void
+ledd_prof_reset(void)
+{
+    memset(prof.total_us, 0, sizeof prof.total_us);
+    memset(prof.max_us, 0, sizeof prof.max_us);
+    memset(prof.wakeups, 0, sizeof prof.wakeups);
+    prof.passes = 0;
+    ledd_hist_reset(&prof.busy);
+    prof.reset_time = time_usec();
+} /* ledd_prof_reset() */
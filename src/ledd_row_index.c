@@ -0,0 +1,185 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the index of OVSDB LED rows by id
+ *
+ ***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "ovsdb-idl.h"
+#include "util.h"
+#include "uuid.h"
+
+#include "ledd_row_index.h"
+
+void
+ledd_row_index_init(struct ledd_row_index *index)
+{
+    shash_init(&index->ids);
+    index->seqno = 0;
+    index->valid = false;
+} /* ledd_row_index_init() */
+
+void
+ledd_row_index_destroy(struct ledd_row_index *index)
+{
+    shash_destroy_free_data(&index->ids);
+    index->valid = false;
+} /* ledd_row_index_destroy() */
+
+/* point id at row, replacing any entry for the id */
+void
+ledd_row_index_add(struct ledd_row_index *index, const struct ovsrec_led *row)
+{
+    struct uuid *uuid;
+
+    if (row->id == NULL) {
+        return;
+    }
+
+    uuid = shash_find_data(&index->ids, row->id);
+    if (uuid == NULL) {
+        uuid = xmalloc(sizeof *uuid);
+        shash_add(&index->ids, row->id, uuid);
+    }
+    *uuid = row->header_.uuid;
+} /* ledd_row_index_add() */
+
+/* drop the entry of id, if it is for row */
+static void
+ledd_row_index_remove(struct ledd_row_index *index,
+                      const struct ovsrec_led *row)
+{
+    struct shash_node *node;
+
+    if (row->id == NULL) {
+        return;
+    }
+
+    node = shash_find(&index->ids, row->id);
+    if (node != NULL && uuid_equals(node->data, &row->header_.uuid)) {
+        free(node->data);
+        shash_delete(&index->ids, node);
+    }
+} /* ledd_row_index_remove() */
+
+/************************************************************************//**
+ * Function that builds the index from every LED row in the IDL.
+ *
+ * Returns: void
+ ***************************************************************************/
+void
+ledd_row_index_rebuild(struct ledd_row_index *index,
+                       const struct ovsdb_idl *idl)
+{
+    const struct ovsrec_led *row;
+
+    shash_clear_free_data(&index->ids);
+    OVSREC_LED_FOR_EACH(row, idl) {
+        /* like a scan of the table, the first row with an id wins */
+        if (row->id != NULL && shash_find(&index->ids, row->id) == NULL) {
+            ledd_row_index_add(index, row);
+        }
+    }
+    index->seqno = ovsdb_idl_get_seqno(idl);
+    index->valid = true;
+} /* ledd_row_index_rebuild() */
+
+/* rebuild the index if the IDL has changed since it was last built */
+void
+ledd_row_index_refresh(struct ledd_row_index *index,
+                       const struct ovsdb_idl *idl)
+{
+    if (!index->valid || index->seqno != ovsdb_idl_get_seqno(idl)) {
+        ledd_row_index_rebuild(index, idl);
+    }
+} /* ledd_row_index_refresh() */
+
+/************************************************************************//**
+ * Function that brings the index up to date with the LED rows inserted,
+ *     deleted or given a new id since the tracked changes were last
+ *     cleared. The IDL must track led:id.
+ *
+ * Logic:
+ *     - build the index from scratch the first time
+ *     - else, if the IDL has changed, foreach tracked LED row
+ *         - drop the entry of a deleted row
+ *         - point the id of any other row at it; an entry left for the
+ *           old id of a renamed row is dropped by its next lookup
+ *
+ * Changes still tracked from an earlier call are applied again, which
+ * leaves the index as it was.
+ *
+ * Returns: void
+ ***************************************************************************/
+void
+ledd_row_index_track(struct ledd_row_index *index,
+                     const struct ovsdb_idl *idl)
+{
+    const struct ovsrec_led *row;
+
+    if (!index->valid) {
+        ledd_row_index_rebuild(index, idl);
+        return;
+    }
+    if (index->seqno == ovsdb_idl_get_seqno(idl)) {
+        return;
+    }
+
+    OVSREC_LED_FOR_EACH_TRACKED(row, idl) {
+        if (ovsrec_led_row_get_seqno(row, OVSDB_IDL_CHANGE_DELETE) > 0) {
+            ledd_row_index_remove(index, row);
+        } else {
+            ledd_row_index_add(index, row);
+        }
+    }
+    index->seqno = ovsdb_idl_get_seqno(idl);
+} /* ledd_row_index_track() */
+
+/************************************************************************//**
+ * Function that looks an LED row up by id.
+ *
+ * Returns: the row, or NULL if there is no row with that id
+ ***************************************************************************/
+const struct ovsrec_led *
+ledd_row_index_find(struct ledd_row_index *index, const struct ovsdb_idl *idl,
+                    const char *id)
+{
+    const struct ovsrec_led *row;
+    struct shash_node *node;
+
+    node = shash_find(&index->ids, id);
+    if (node == NULL) {
+        return(NULL);
+    }
+
+    row = ovsrec_led_get_for_uuid(idl, node->data);
+    if (row == NULL || row->id == NULL || strcmp(row->id, id)) {
+        /* stale: the row is gone or has another id now */
+        free(node->data);
+        shash_delete(&index->ids, node);
+        return(NULL);
+    }
+
+    return(row);
+} /* ledd_row_index_find() */
@@ -0,0 +1,136 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd shards
+ *
+ ***************************************************************************/
+
+#include <ctype.h>
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "hash.h"
+#include "util.h"
+
+#include "ledd_shard.h"
+
+/************************************************************************//**
+ * Function that parses a shard (see ledd_shard.h) into shard.
+ *
+ * Logic:
+ *     - "hash:A-B/N" or "hash:A/N": the hash slots A to B, of N
+ *     - anything else: a subsystem name pattern, checked by fnmatch()
+ *
+ * Returns: NULL, or an error message to be freed by the caller; shard is
+ *          only set on success
+ ***************************************************************************/
+char *
+ledd_shard_parse(struct ledd_shard *shard, const char *spec)
+{
+    unsigned int first, last, n_slots;
+    int n = 0;
+
+    if (spec[0] == '\0') {
+        return(xstrdup("shard is empty"));
+    }
+
+    memset(shard, 0, sizeof *shard);
+    if (!strncmp(spec, LEDD_SHARD_HASH_PREFIX,
+                 strlen(LEDD_SHARD_HASH_PREFIX))) {
+        const char *slots = spec + strlen(LEDD_SHARD_HASH_PREFIX);
+
+        if (sscanf(slots, "%u-%u/%u%n", &first, &last, &n_slots, &n) == 3
+            && slots[n] == '\0') {
+            /* "A-B/N" */
+        } else if (sscanf(slots, "%u/%u%n", &first, &n_slots, &n) == 2
+                   && slots[n] == '\0') {
+            last = first;
+        } else {
+            return(xasprintf("%s: expected %sA-B/N", spec,
+                             LEDD_SHARD_HASH_PREFIX));
+        }
+        if (n_slots == 0 || first > last || last >= n_slots) {
+            return(xasprintf("%s: slots must be from 0 to N-1", spec));
+        }
+        shard->first = first;
+        shard->last = last;
+        shard->n_slots = n_slots;
+    } else {
+        shard->pattern = xstrdup(spec);
+    }
+    shard->spec = xstrdup(spec);
+
+    return(NULL);
+} /* ledd_shard_parse() */
+
+void
+ledd_shard_destroy(struct ledd_shard *shard)
+{
+    free(shard->spec);
+    free(shard->pattern);
+    memset(shard, 0, sizeof *shard);
+} /* ledd_shard_destroy() */
+
+/* true if the subsystem called name belongs to shard. The hash of the name
+   does not depend on the process, so every process agrees on its slot. */
+bool
+ledd_shard_owns(const struct ledd_shard *shard, const char *name)
+{
+    unsigned int slot;
+
+    if (shard->spec == NULL) {
+        return(true);
+    }
+    if (shard->pattern != NULL) {
+        return(fnmatch(shard->pattern, name, 0) == 0);
+    }
+
+    slot = hash_string(name, 0) % shard->n_slots;
+    return(slot >= shard->first && slot <= shard->last);
+} /* ledd_shard_owns() */
+
+/* default lock name of shard: base, then "_shard_" and the hash of the
+   shard in hex, to be freed by the caller */
+char *
+ledd_shard_lock_name(const struct ledd_shard *shard, const char *base)
+{
+    return(xasprintf("%s_shard_%08x", base, hash_string(shard->spec, 0)));
+} /* ledd_shard_lock_name() */
+
+/* true if name is an id, as ovsdb-server requires of a lock name */
+bool
+ledd_shard_is_lock_name(const char *name)
+{
+    const char *p;
+
+    if (!isalpha((unsigned char)name[0]) && name[0] != '_') {
+        return(false);
+    }
+    for (p = name + 1; *p != '\0'; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_') {
+            return(false);
+        }
+    }
+
+    return(true);
+} /* ledd_shard_is_lock_name() */
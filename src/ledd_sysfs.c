@@ -0,0 +1,393 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd Linux LED class backend
+ *
+ ***************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "util.h"
+#include "openvswitch/vlog.h"
+
+#include "ledd_sysfs.h"
+
+VLOG_DEFINE_THIS_MODULE(ledd_sysfs);
+
+static struct vlog_rate_limit sysfs_rl = VLOG_RATE_LIMIT_INIT(5, 20);
+
+/* LED class directory that "sysfs:<name>" devices are relative to */
+static char *sysfs_dir;
+
+void
+ledd_sysfs_set_dir(const char *dir)
+{
+    free(sysfs_dir);
+    sysfs_dir = xstrdup(dir);
+} /* ledd_sysfs_set_dir() */
+
+bool
+ledd_sysfs_is_sysfs(const char *device)
+{
+    return(device != NULL
+           && !strncmp(device, LEDD_SYSFS_PREFIX, strlen(LEDD_SYSFS_PREFIX)));
+} /* ledd_sysfs_is_sysfs() */
+
+/* open an attribute file of an LED class device, for writing */
+static int
+ledd_sysfs_open_file(const char *path, const char *file)
+{
+    char *name = xasprintf("%s/%s", path, file);
+    int fd;
+
+    fd = open(name, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        VLOG_WARN_RL(&sysfs_rl, "%s: open failed (%s)", name,
+                     ovs_strerror(errno));
+    }
+    free(name);
+    return(fd);
+} /* ledd_sysfs_open_file() */
+
+static void
+ledd_sysfs_close_fd(int *fd)
+{
+    if (*fd >= 0) {
+        close(*fd);
+        *fd = -1;
+    }
+} /* ledd_sysfs_close_fd() */
+
+/* write a value to an open attribute file. sysfs attributes take the
+   whole value in one write at offset 0, so no seek or reopen is needed */
+static int
+ledd_sysfs_write(struct ledd_sysfs_led *led, int fd, const char *file,
+                 const char *value)
+{
+    size_t len = strlen(value);
+    ssize_t n;
+
+    led->n_writes++;
+    n = pwrite(fd, value, len, 0);
+    if (n < 0 || (size_t)n != len) {
+        int error = n < 0 ? errno : EIO;
+
+        VLOG_WARN_RL(&sysfs_rl, "%s/%s: write of \"%.*s\" failed (%s)",
+                     led->path, file, (int)strcspn(value, "\n"), value,
+                     ovs_strerror(error));
+        return(error);
+    }
+    return(0);
+} /* ledd_sysfs_write() */
+
+static int
+ledd_sysfs_write_uint(struct ledd_sysfs_led *led, int fd,
+                      const char *file, unsigned int value)
+{
+    char buf[16];
+
+    snprintf(buf, sizeof buf, "%u\n", value);
+    return(ledd_sysfs_write(led, fd, file, buf));
+} /* ledd_sysfs_write_uint() */
+
+/* read the value of an attribute file of an LED class device; false if
+   it cannot be read */
+static bool
+ledd_sysfs_read_file(const char *path, const char *file, char *buf,
+                     size_t size)
+{
+    char *name = xasprintf("%s/%s", path, file);
+    ssize_t n = -1;
+    int fd;
+
+    fd = open(name, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        n = read(fd, buf, size - 1);
+        close(fd);
+    }
+    free(name);
+
+    if (n < 0) {
+        return(false);
+    }
+    buf[n] = '\0';
+    return(true);
+} /* ledd_sysfs_read_file() */
+
+static bool
+ledd_sysfs_read_uint(const char *path, const char *file, unsigned int *value)
+{
+    char buf[32];
+    char *end;
+
+    if (!ledd_sysfs_read_file(path, file, buf, sizeof buf)) {
+        return(false);
+    }
+    *value = strtoul(buf, &end, 10);
+    return(end != buf);
+} /* ledd_sysfs_read_uint() */
+
+/************************************************************************//**
+ * Function that reads back the state an LED class device was left in (by
+ *     an earlier ops-ledd, or the kernel), so that writes of the values it
+ *     already has are skipped.
+ *
+ * Logic:
+ *     - read the trigger in effect, the one in brackets in the trigger
+ *       file; anything other than none or timer is left to the first write
+ *       to replace
+ *     - with no trigger, read the brightness
+ *     - with the timer trigger, open the delay files and read the delays;
+ *       the brightness file follows the blinking, so it is only the blink
+ *       brightness if the LED is lit right now
+ *
+ * Returns: void; what could not be read is left unknown
+ ***************************************************************************/
+static void
+ledd_sysfs_read_back(struct ledd_sysfs_led *led)
+{
+    char trigger[4096];
+    const char *active;
+
+    if (!ledd_sysfs_read_file(led->path, "trigger", trigger,
+                              sizeof trigger)) {
+        return;
+    }
+
+    active = strchr(trigger, '[');
+    if (active == NULL) {
+        return;
+    }
+    active++;
+
+    if (!strncmp(active, "none]", 5)) {
+        led->timer = false;
+        led->brightness_valid = ledd_sysfs_read_uint(led->path, "brightness",
+                                                     &led->brightness);
+    } else if (!strncmp(active, "timer]", 6)) {
+        led->delay_on_fd = ledd_sysfs_open_file(led->path, "delay_on");
+        led->delay_off_fd = ledd_sysfs_open_file(led->path, "delay_off");
+        if (led->delay_on_fd < 0 || led->delay_off_fd < 0
+            || !ledd_sysfs_read_uint(led->path, "delay_on", &led->delay_on)
+            || !ledd_sysfs_read_uint(led->path, "delay_off",
+                                     &led->delay_off)) {
+            return;
+        }
+        led->brightness_valid = (ledd_sysfs_read_uint(led->path, "brightness",
+                                                      &led->brightness)
+                                 && led->brightness != 0);
+    }
+} /* ledd_sysfs_read_back() */
+
+/************************************************************************//**
+ * Function that forgets what is known of the state of an LED, and reads it
+ *     back again; used when another process may have written the LED.
+ *
+ * Returns: void
+ ***************************************************************************/
+void
+ledd_sysfs_refresh(struct ledd_sysfs_led *led)
+{
+    ledd_sysfs_close_fd(&led->delay_on_fd);
+    ledd_sysfs_close_fd(&led->delay_off_fd);
+    led->timer = true;
+    led->brightness_valid = false;
+    led->delay_on = led->delay_off = 0;
+    ledd_sysfs_read_back(led);
+} /* ledd_sysfs_refresh() */
+
+/************************************************************************//**
+ * Function that opens the LED class device of a led_access device of
+ *     "sysfs:<name>" or "sysfs:<path>", keeping its brightness and trigger
+ *     files open for the life of the subsystem.
+ *
+ * Logic:
+ *     - resolve the device to a directory, under the LED class directory
+ *       unless it is an absolute path
+ *     - open brightness and trigger for writing
+ *     - leave the LED in whatever state it is in, and read that state
+ *       back; the first ledd_sysfs_set() or ledd_sysfs_blink() writes the
+ *       files that do not already have the value it needs
+ *
+ * Returns: the LED, to be freed with ledd_sysfs_close(), or NULL if its
+ *          files could not be opened
+ ***************************************************************************/
+struct ledd_sysfs_led *
+ledd_sysfs_open(const char *device)
+{
+    struct ledd_sysfs_led *led;
+    const char *name;
+
+    if (!ledd_sysfs_is_sysfs(device)) {
+        return(NULL);
+    }
+
+    name = device + strlen(LEDD_SYSFS_PREFIX);
+    if (name[0] == '\0') {
+        VLOG_WARN("%s: no LED class device name", device);
+        return(NULL);
+    }
+
+    led = xzalloc(sizeof *led);
+    led->path = (name[0] == '/'
+                 ? xstrdup(name)
+                 : xasprintf("%s/%s", sysfs_dir ? sysfs_dir : LEDD_SYSFS_DIR,
+                             name));
+    led->delay_on_fd = -1;
+    led->delay_off_fd = -1;
+
+    led->brightness_fd = ledd_sysfs_open_file(led->path, "brightness");
+    led->trigger_fd = ledd_sysfs_open_file(led->path, "trigger");
+    if (led->brightness_fd < 0 || led->trigger_fd < 0) {
+        ledd_sysfs_close(led);
+        return(NULL);
+    }
+
+    /* unless it is read back, the trigger in effect is not known, so the
+       first write sets one */
+    led->timer = true;
+    ledd_sysfs_read_back(led);
+
+    return(led);
+} /* ledd_sysfs_open() */
+
+void
+ledd_sysfs_close(struct ledd_sysfs_led *led)
+{
+    if (led != NULL) {
+        ledd_sysfs_close_fd(&led->brightness_fd);
+        ledd_sysfs_close_fd(&led->trigger_fd);
+        ledd_sysfs_close_fd(&led->delay_on_fd);
+        ledd_sysfs_close_fd(&led->delay_off_fd);
+        free(led->path);
+        free(led);
+    }
+} /* ledd_sysfs_close() */
+
+/************************************************************************//**
+ * Function that sets an LED to a steady brightness.
+ *
+ * Logic:
+ *     - if the timer trigger may be active, select no trigger; the delay
+ *       files go away with it
+ *     - write the brightness, unless it is already set
+ *
+ * Returns: 0, or an errno value
+ ***************************************************************************/
+int
+ledd_sysfs_set(struct ledd_sysfs_led *led, uint32_t brightness)
+{
+    int error;
+
+    if (led->timer) {
+        error = ledd_sysfs_write(led, led->trigger_fd, "trigger", "none\n");
+        if (error) {
+            return(error);
+        }
+        led->timer = false;
+        led->brightness_valid = false;
+        ledd_sysfs_close_fd(&led->delay_on_fd);
+        ledd_sysfs_close_fd(&led->delay_off_fd);
+    }
+
+    if (led->brightness_valid && led->brightness == brightness) {
+        return(0);
+    }
+
+    error = ledd_sysfs_write_uint(led, led->brightness_fd, "brightness",
+                                  brightness);
+    led->brightness = brightness;
+    led->brightness_valid = !error;
+    return(error);
+} /* ledd_sysfs_set() */
+
+/************************************************************************//**
+ * Function that makes an LED flash, using the kernel timer trigger.
+ *
+ * Logic:
+ *     - unless the timer trigger is already flashing the LED at this
+ *       brightness, write the brightness, select the timer trigger and
+ *       open the delay_on and delay_off files it creates; the timer
+ *       flashes at the brightness the LED has when the trigger is selected
+ *     - write the delays that differ from the ones last written; a newly
+ *       selected trigger has its own defaults, so both are written then
+ *
+ * Returns: 0, or an errno value
+ ***************************************************************************/
+int
+ledd_sysfs_blink(struct ledd_sysfs_led *led, uint32_t brightness,
+                 unsigned int delay_on, unsigned int delay_off)
+{
+    int error;
+
+    if (!led->timer || led->delay_on_fd < 0 || led->delay_off_fd < 0
+        || !led->brightness_valid || led->brightness != brightness) {
+        ledd_sysfs_close_fd(&led->delay_on_fd);
+        ledd_sysfs_close_fd(&led->delay_off_fd);
+
+        error = ledd_sysfs_write_uint(led, led->brightness_fd, "brightness",
+                                      brightness);
+        led->brightness = brightness;
+        led->brightness_valid = !error;
+        led->timer = false;
+        if (error) {
+            return(error);
+        }
+
+        /* if this fails, the trigger in effect is not known */
+        led->timer = true;
+        error = ledd_sysfs_write(led, led->trigger_fd, "trigger", "timer\n");
+        if (error) {
+            return(error);
+        }
+
+        led->delay_on_fd = ledd_sysfs_open_file(led->path, "delay_on");
+        led->delay_off_fd = ledd_sysfs_open_file(led->path, "delay_off");
+        if (led->delay_on_fd < 0 || led->delay_off_fd < 0) {
+            return(ENOENT);
+        }
+        led->delay_on = led->delay_off = 0;
+    }
+
+    if (led->delay_on != delay_on) {
+        error = ledd_sysfs_write_uint(led, led->delay_on_fd, "delay_on",
+                                      delay_on);
+        if (error) {
+            return(error);
+        }
+        led->delay_on = delay_on;
+    }
+    if (led->delay_off != delay_off) {
+        error = ledd_sysfs_write_uint(led, led->delay_off_fd, "delay_off",
+                                      delay_off);
+        if (error) {
+            return(error);
+        }
+        led->delay_off = delay_off;
+    }
+
+    return(0);
+} /* ledd_sysfs_blink() */
@@ -0,0 +1,171 @@
+/*
+ * (c) Copyright 2015 Hewlett Packard Enterprise Development LP
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *   not use this file except in compliance with the License. You may obtain
+ *   a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *   WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ *   License for the specific language governing permissions and limitations
+ *   under the License.
+ */
+
+/************************************************************************//**
+ * @ingroup ops-ledd
+ *
+ * @file
+ * Source file for the ops-ledd timer wheel
+ *
+ ***************************************************************************/
+
+#include <limits.h>
+
+#include "config.h"
+#include "poll-loop.h"
+#include "util.h"
+
+#include "ledd_wheel.h"
+
+/* initialize an empty wheel, with ticks of tick_ms */
+void
+ledd_wheel_init(struct ledd_wheel *wheel, long long int tick_ms)
+{
+    size_t i;
+
+    for (i = 0; i < LEDD_WHEEL_SLOTS; i++) {
+        list_init(&wheel->slots[i]);
+    }
+    wheel->tick_ms = tick_ms;
+    wheel->cur_tick = 0;
+    wheel->n_timers = 0;
+} /* ledd_wheel_init() */
+
+/************************************************************************//**
+ * Function that schedules a timer, which must not already be in a wheel.
+ *     The timer goes in the slot of the first tick at or after its expiry
+ *     time, so it never expires early.
+ *
+ * Returns: void
+ ***************************************************************************/
+void
+ledd_wheel_add(struct ledd_wheel *wheel, struct ledd_wheel_timer *timer,
+               long long int when)
+{
+    long long int tick = DIV_ROUND_UP(when, wheel->tick_ms);
+
+    if (wheel->n_timers == 0 || tick < wheel->cur_tick) {
+        /* Nothing to expire before this timer. */
+        wheel->cur_tick = tick;
+    }
+
+    timer->when = when;
+    list_push_back(&wheel->slots[tick & (LEDD_WHEEL_SLOTS - 1)],
+                   &timer->node);
+    wheel->n_timers++;
+} /* ledd_wheel_add() */
+
+/* cancel a timer; does nothing if the timer is not scheduled */
+void
+ledd_wheel_remove(struct ledd_wheel *wheel, struct ledd_wheel_timer *timer)
+{
+    if (ledd_wheel_is_scheduled(timer)) {
+        list_remove(&timer->node);
+        list_init(&timer->node);
+        wheel->n_timers--;
+    }
+} /* ledd_wheel_remove() */
+
+/************************************************************************//**
+ * Function that removes and returns the next timer that has expired at
+ *     time now. Call it until it returns NULL.
+ *
+ * Logic:
+ *     - walk the slots from the first tick not yet expired up to now;
+ *       after a long stall, each slot is walked once
+ *     - return the first timer in the slot that has expired; timers for
+ *       later turns of the wheel stay in place
+ *
+ * Returns: an expired timer, or NULL if there are none
+ ***************************************************************************/
+struct ledd_wheel_timer *
+ledd_wheel_expired(struct ledd_wheel *wheel, long long int now)
+{
+    long long int now_tick = now / wheel->tick_ms;
+    struct ledd_wheel_timer *timer;
+
+    if (wheel->n_timers == 0) {
+        return(NULL);
+    }
+
+    if (now_tick - wheel->cur_tick >= LEDD_WHEEL_SLOTS) {
+        wheel->cur_tick = now_tick - LEDD_WHEEL_SLOTS + 1;
+    }
+
+    for (; wheel->cur_tick <= now_tick; wheel->cur_tick++) {
+        struct ovs_list *slot;
+
+        slot = &wheel->slots[wheel->cur_tick & (LEDD_WHEEL_SLOTS - 1)];
+        LIST_FOR_EACH(timer, node, slot) {
+            if (timer->when <= now) {
+                ledd_wheel_remove(wheel, timer);
+                return(timer);
+            }
+        }
+    }
+
+    return(NULL);
+} /* ledd_wheel_expired() */
+
+/************************************************************************//**
+ * Function that finds when the next timer expires. The slots are walked
+ * from the current tick, so the walk stops at the first slot holding a
+ * timer for this turn of the wheel.
+ *
+ * Returns: the expiry time of the next timer, or LLONG_MAX if none
+ ***************************************************************************/
+long long int
+ledd_wheel_next(const struct ledd_wheel *wheel)
+{
+    const struct ledd_wheel_timer *timer;
+    long long int next = LLONG_MAX;
+    long long int tick;
+
+    if (wheel->n_timers == 0) {
+        return(LLONG_MAX);
+    }
+
+    for (tick = wheel->cur_tick; tick < wheel->cur_tick + LEDD_WHEEL_SLOTS;
+         tick++) {
+        const struct ovs_list *slot;
+        long long int tick_end = tick * wheel->tick_ms;
+        long long int slot_next = LLONG_MAX;
+
+        slot = &wheel->slots[tick & (LEDD_WHEEL_SLOTS - 1)];
+        LIST_FOR_EACH(timer, node, slot) {
+            if (timer->when <= tick_end) {
+                slot_next = MIN(slot_next, timer->when);
+            }
+            next = MIN(next, timer->when);
+        }
+        if (slot_next != LLONG_MAX) {
+            return(slot_next);
+        }
+    }
+
+    return(next);
+} /* ledd_wheel_next() */
+
+/* arrange for the poll loop to wake up when the next timer expires */
+void
+ledd_wheel_wait(const struct ledd_wheel *wheel)
+{
+    long long int next = ledd_wheel_next(wheel);
+
+    if (next != LLONG_MAX) {
+        poll_timer_wait_until(next);
+    }
+} /* ledd_wheel_wait() */